@@ -34,6 +34,7 @@
 #include "Logger.hpp"
 #include "MonitoringClients.hpp"
 #include "LongTimeAction.hpp"
+#include "MessageGarbler.hpp"
 
 #include "data/Data.hpp"
 #include "data/RaceTypeTable.hpp"
@@ -1091,7 +1092,7 @@ bool Character::isInScreen(const position &pos) const {
     short int dy = abs(this->pos.y - pos.y);
     short int dz = abs(this->pos.z - pos.z);
 
-    return dx + dy <= getScreenRange() && -RANGEDOWN <= dz && dz <= RANGEUP;
+    return dx + dy <= std::min<int>(getScreenRange(), MAX_SCREEN_RANGE) && -RANGEDOWN <= dz && dz <= RANGEUP;
 }
 
 unsigned short int Character::getScreenRange() const {
@@ -1245,20 +1246,7 @@ void Character::increaseMentalCapacity(int value) {
 }
 
 std::string Character::alterSpokenMessage(const std::string &message, int languageSkill) const {
-    int counter=0;
-    std::string alteredMessage;
-
-    alteredMessage=message;
-
-    while (message[counter]!=0) {
-        if (Random::uniform(0,70)>languageSkill) {
-            alteredMessage[counter]='*';
-        }
-
-        counter++;
-    }
-
-    return alteredMessage;
+    return MessageGarbler::garble(message, languageSkill);
 }
 
 int Character::getLanguageSkill(int languageSkillNumber) const {
@@ -85,11 +85,11 @@ auto CharacterContainer<T>::find(const position &pos) const -> pointer {
 
 
 template <class T>
-void CharacterContainer<T>::update(pointer p, const position& newPosition) {
+bool CharacterContainer<T>::update(pointer p, const position& newPosition) {
     const auto id = p->getId();
 
     if (!find(id)) {
-        return;
+        return false;
     }
 
     const auto &oldPosition = p->getPosition();
@@ -99,9 +99,11 @@ void CharacterContainer<T>::update(pointer p, const position& newPosition) {
         if (it->second == id) {
             position_to_id.erase(it);
             position_to_id.insert(std::make_pair(newPosition, id));
-            return;
+            return true;
         }
     }
+
+    return true;
 }
 
 
@@ -148,7 +150,6 @@ auto CharacterContainer<T>::findAllCharactersInRangeOf(const position &pos, cons
 template <class T>
 auto CharacterContainer<T>::findAllCharactersInScreen(const position &pos) const -> std::vector<pointer> {
     std::vector<pointer> temp;
-    const int MAX_SCREEN_RANGE = 30;
     auto candidates = projection_x_axis(pos,MAX_SCREEN_RANGE);
     
     for (auto& c : candidates) {
@@ -67,7 +67,8 @@ public:
     pointer find(const std::string &name) const;
     pointer find(TYPE_OF_CHARACTER_ID id) const;
     pointer find(const position &pos) const;
-    void update(pointer p, const position& newPosition);
+    // returns false if p is not in the container
+    bool update(pointer p, const position& newPosition);
     bool erase(TYPE_OF_CHARACTER_ID id);
     void clear() {
         container.clear();
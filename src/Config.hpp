@@ -87,6 +87,8 @@ public:
     ConfigEntry<std::string> scriptdir = { "scriptdir", "./script/" };
 
     ConfigEntry<uint16_t> port = { "port", 3012 };
+    ConfigEntry<uint16_t> metrics_port = { "metrics_port", 0 };
+    ConfigEntry<std::string> metrics_address = { "metrics_address", "127.0.0.1" };
 
     ConfigEntry<std::string> postgres_db = { "postgres_db", "illarion" };
     ConfigEntry<std::string> postgres_user = { "postgres_user", "illarion" };
@@ -96,9 +98,20 @@ public:
     ConfigEntry<std::string> postgres_schema_server = { "postgres_schema_server", "server" };
     ConfigEntry<std::string> postgres_schema_account = { "postgres_schema_account", "accounts" };
 
+    ConfigEntry<std::string> log_file = { "log_file", "" };
+
     ConfigEntry<int16_t> debug = { "debug", 0 };
+    ConfigEntry<int16_t> save_statistics = { "save_statistics", 0 };
+    ConfigEntry<int16_t> lua_profiling = { "lua_profiling", 0 };
+    ConfigEntry<uint16_t> lua_slow_call_threshold = { "lua_slow_call_threshold", 0 };
+    ConfigEntry<std::string> lua_gc_mode = { "lua_gc_mode", "incremental" };
+    ConfigEntry<uint16_t> lua_gc_pause = { "lua_gc_pause", 200 };
+    ConfigEntry<uint16_t> lua_gc_stepmul = { "lua_gc_stepmul", 200 };
+    ConfigEntry<uint16_t> lua_gc_step_time = { "lua_gc_step_time", 2 };
 
     ConfigEntry<uint16_t> clientversion = { "clientversion", 122 };
+    ConfigEntry<uint16_t> login_workers = { "login_workers", 4 };
+    ConfigEntry<int16_t> monster_ai_workers = { "monster_ai_workers", -1 };
     ConfigEntry<int16_t> playerstart_x = { "playerstart_x", 0 };
     ConfigEntry<int16_t> playerstart_y = { "playerstart_y", 0 };
     ConfigEntry<int16_t> playerstart_z = { "playerstart_z", 0 };
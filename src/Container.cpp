@@ -20,7 +20,7 @@
 #include "data/Data.hpp"
 #include "World.hpp"
 
-Container::Container(Item::id_type itemId): itemId(itemId) {
+Container::Container(Item::id_type itemId): itemId(itemId), weightGeneration(ItemTable::getGeneration()) {
 }
 
 Container::Container(const Container &source) {
@@ -29,27 +29,24 @@ Container::Container(const Container &source) {
 
 Container &Container::operator=(const Container &source) {
     if (this != &source) {
-        itemId = source.itemId;
+        clearContent();
 
-        items.clear();
+        itemId = source.itemId;
         items = source.items;
 
-        if (!containers.empty()) {
-            for (auto it = containers.begin(); it != containers.end(); ++it) {
-                delete it->second;
-                it->second = nullptr;
-            }
-
-            containers.clear();
+        for (auto it = source.containers.cbegin(); it != source.containers.cend(); ++it) {
+            auto container = new Container(*(it->second));
+            container->parent = this;
+            containers.insert(CONTAINERMAP::value_type(it->first, container));
         }
 
-        if (!source.containers.empty()) {
+        contentWeight = source.contentWeight;
+        weightGeneration = source.weightGeneration;
+        itemCounts = source.itemCounts;
 
-            for (auto it = source.containers.cbegin(); it != source.containers.cend(); ++it) {
-                containers.insert(CONTAINERMAP::value_type(it->first, new Container(*(it->second))));
-            }
+        if (parent) {
+            parent->changeContent(*this, 1);
         }
-
     }
 
     return *this;
@@ -70,14 +67,16 @@ Container::~Container() {
 }
 
 Item::number_type Container::mergeItem(Item item) {
-    if (isItemStackable(item)) {
+    if (isItemStackable(item) && indexedCount(item.getId()) > 0) {
         auto it = items.begin();
 
         while ((it != items.end()) && (item.getNumber() > 0)) {
             Item &selectedItem = it->second;
 
             if (selectedItem.getId() == item.getId() && selectedItem.equalData(item)) {
+                itemRemoved(selectedItem);
                 Item::number_type number = selectedItem.increaseNumberBy(item.getNumber());
+                itemAdded(selectedItem);
 
                 if (number != item.getNumber()) {
                     item.setNumber(number);
@@ -138,13 +137,17 @@ bool Container::InsertItem(Item item, TYPE_OF_CONTAINERSLOTS pos) {
                     auto maxStack = item.getMaxStack();
 
                     if (temp <= maxStack) {
+                        itemRemoved(selectedItem);
                         selectedItem.setMinQuality(item);
                         selectedItem.setNumber(temp);
+                        itemAdded(selectedItem);
                         return true;
                     } else if (items.size() < getSlotCount()) {
+                        itemRemoved(selectedItem);
                         item.setNumber(item.getNumber() - maxStack + selectedItem.getNumber());
                         selectedItem.setMinQuality(item);
                         selectedItem.setNumber(maxStack);
+                        itemAdded(selectedItem);
                         insertIntoFirstFreeSlot(item);
                         return true;
                     }
@@ -152,6 +155,7 @@ bool Container::InsertItem(Item item, TYPE_OF_CONTAINERSLOTS pos) {
             }
         } else if (items.size() < getSlotCount()) {
             items.insert(ITEMMAP::value_type(pos, item));
+            itemAdded(item);
             return true;
         }
     }
@@ -160,7 +164,7 @@ bool Container::InsertItem(Item item, TYPE_OF_CONTAINERSLOTS pos) {
 }
 
 bool Container::InsertContainer(Item it, Container *cc) {
-    if ((this != cc) && (items.size() < getSlotCount())) {
+    if ((this != cc) && !isNestedIn(cc) && (items.size() < getSlotCount())) {
         Item titem = it;
         insertIntoFirstFreeSlot(titem, cc);
         return true;
@@ -171,7 +175,7 @@ bool Container::InsertContainer(Item it, Container *cc) {
 }
 
 bool Container::InsertContainer(Item it, Container *cc, TYPE_OF_CONTAINERSLOTS pos) {
-    if ((this != cc) && (pos < getSlotCount())) {
+    if ((this != cc) && !isNestedIn(cc) && (pos < getSlotCount())) {
         Item titem = it;
 
         auto iterat = items.find(pos);
@@ -181,6 +185,8 @@ bool Container::InsertContainer(Item it, Container *cc, TYPE_OF_CONTAINERSLOTS p
         } else {
             items.insert(ITEMMAP::value_type(pos, titem));
             containers.insert(CONTAINERMAP::value_type(pos, cc));
+            itemAdded(titem);
+            containerAdded(cc);
             World::get()->sendContainerSlotChange(this, pos);
             return true;
         }
@@ -205,10 +211,12 @@ bool Container::changeQualityAt(TYPE_OF_CONTAINERSLOTS nr, short int amount) {
                 auto iterat = containers.find(nr);
 
                 if (iterat != containers.end()) {
+                    containerRemoved(iterat->second);
                     containers.erase(iterat);
                 }
             }
 
+            itemRemoved(item);
             items.erase(nr);
             return true;
         }
@@ -225,11 +233,13 @@ bool Container::TakeItemNr(TYPE_OF_CONTAINERSLOTS nr, Item &item, Container *&cc
         item = selectedItem;
 
         if (item.isContainer()) {
+            itemRemoved(selectedItem);
             items.erase(nr);
             auto iterat = containers.find(nr);
 
             if (iterat != containers.end()) {
                 cc = (*iterat).second;
+                containerRemoved(cc);
                 containers.erase(iterat);
             } else {
                 cc = new Container(item.getId());
@@ -239,11 +249,13 @@ bool Container::TakeItemNr(TYPE_OF_CONTAINERSLOTS nr, Item &item, Container *&cc
 
         } else {
             cc = nullptr;
+            itemRemoved(selectedItem);
 
             if (isItemStackable(item) && count > 1) {
                 if (selectedItem.getNumber() > count) {
                     selectedItem.setNumber(selectedItem.getNumber() - count);
                     item.setNumber(count);
+                    itemAdded(selectedItem);
                 } else {
                     items.erase(nr);
                 }
@@ -251,6 +263,7 @@ bool Container::TakeItemNr(TYPE_OF_CONTAINERSLOTS nr, Item &item, Container *&cc
                 if (selectedItem.getNumber() > 1) {
                     selectedItem.setNumber(selectedItem.getNumber() - 1);
                     item.setNumber(1);
+                    itemAdded(selectedItem);
                 } else {
                     items.erase(nr);
                 }
@@ -401,15 +414,18 @@ int Container::increaseAtPos(unsigned char pos, int count) {
             temp = item.getNumber() + count;
 
             auto maxStack = item.getMaxStack();
+            itemRemoved(item);
 
             if (temp > maxStack) {
                 item.setNumber(maxStack);
+                itemAdded(item);
                 temp = temp - maxStack;
             } else if (temp <= 0) {
                 temp = count + item.getNumber();
                 items.erase(pos);
             } else {
                 item.setNumber(temp);
+                itemAdded(item);
                 temp = 0;
             }
         }
@@ -423,7 +439,9 @@ bool Container::changeItem(ScriptItem &item) {
 
     if (it != items.end()) {
         if (!it->second.isContainer()) {
+            itemRemoved(it->second);
             it->second = item;
+            itemAdded(it->second);
             return true;
         }
     }
@@ -438,7 +456,9 @@ bool Container::swapAtPos(unsigned char pos, Item::id_type newid, Item::quality_
         Item &item = it->second;
 
         if (!item.isContainer()) {
+            itemRemoved(item);
             item.setId(newid);
+            itemAdded(item);
 
             if (newQuality > 0) {
                 item.setQuality(newQuality);
@@ -474,17 +494,7 @@ void Container::Save(std::ofstream &where) {
 }
 
 void Container::Load(std::istream &where) {
-
-    if (!containers.empty()) {
-
-        for (auto it = containers.begin(); it != containers.end(); ++it) {
-            delete it->second;
-            it->second = nullptr;
-        }
-    }
-
-    items.clear();
-    containers.clear();
+    clearContent();
 
     MAXCOUNTTYPE size;
     where.read((char *) & size, sizeof(size));
@@ -509,12 +519,16 @@ void Container::Load(std::istream &where) {
 }
 
 int Container::countItem(Item::id_type itemid, script_data_exchangemap const *data) const {
+    if (data == nullptr || indexedCount(itemid) == 0) {
+        return indexedCount(itemid);
+    }
+
     int temp = 0;
 
     for (auto it = items.begin(); it != items.end(); ++it) {
         const Item &item = it->second;
 
-        if (item.getId() == itemid && (data == nullptr || item.hasData(*data))) {
+        if (item.getId() == itemid && item.hasData(*data)) {
             temp = temp + item.getNumber();
         }
 
@@ -531,47 +545,40 @@ int Container::countItem(Item::id_type itemid, script_data_exchangemap const *da
 }
 
 int Container::weight() {
-    return recursiveWeight(0);
-}
-
-int Container::recursiveWeight(int rekt) {
-    int temprekt = rekt + 1;
-
-    if (rekt > MAXIMALEREKURSIONSTIEFE) {
-        throw RecursionException();
+    if (weightGeneration != ItemTable::getGeneration()) {
+        recalculateWeight();
     }
 
-    uint32_t temp = 0;
-
-    for (auto it = items.begin(); it != items.end(); ++it) {
-        Item &item = it->second;
-
-        const auto &itemStruct = Data::Items[item.getId()];
-
-        if (item.isContainer()) {
-            auto iterat = containers.find(it->first);
+    if (contentWeight > 30000) {
+        return 30000;
+    } else {
+        return contentWeight;
+    }
+}
 
-            if (iterat != containers.end()) {
-                temp += iterat->second->recursiveWeight(temprekt);
-            }
+uint32_t Container::recalculateWeight() {
+    contentWeight = 0;
 
-            temp += itemStruct.Weight;
-        } else {
-            temp += (itemStruct.Weight * item.getNumber());
-        }
+    for (const auto &slot : items) {
+        contentWeight += itemWeight(slot.second);
     }
 
-    if (temp > 30000) {
-        return 30000;
-    } else {
-        return temp;
+    for (const auto &slot : containers) {
+        contentWeight += slot.second->recalculateWeight();
     }
+
+    weightGeneration = ItemTable::getGeneration();
+    return contentWeight;
 }
 
 int Container::eraseItem(Item::id_type itemid, Item::number_type count, script_data_exchangemap const *data) {
 
     int temp = count;
 
+    if (indexedCount(itemid) == 0) {
+        return temp;
+    }
+
     auto it = items.begin();
 
     while (it != items.end()) {
@@ -586,6 +593,7 @@ int Container::eraseItem(Item::id_type itemid, Item::number_type count, script_d
 
             ++it;
         } else if ((item.getId() == itemid && (data == nullptr || item.hasData(*data))) && (temp > 0)) {
+            itemRemoved(item);
 
             if (temp >= item.getNumber()) {
                 temp = temp - item.getNumber();
@@ -593,6 +601,7 @@ int Container::eraseItem(Item::id_type itemid, Item::number_type count, script_d
 
             } else {
                 item.setNumber(item.getNumber() - temp);
+                itemAdded(item);
                 temp = 0;
                 ++it;
             }
@@ -616,7 +625,9 @@ void Container::doAge(bool inventory) {
             if (!inventory || (inventory && itemStruct.rotsInInventory)) {
                 if (!item.survivesAgeing()) {
                     if (item.getId() != itemStruct.ObjectAfterRot) {
+                        itemRemoved(item);
                         item.setId(itemStruct.ObjectAfterRot);
+                        itemAdded(item);
 
                         const auto &afterRotItemStruct = Data::Items[itemStruct.ObjectAfterRot];
 
@@ -631,10 +642,12 @@ void Container::doAge(bool inventory) {
                             auto iterat = containers.find(it->first);
 
                             if (iterat != containers.end()) {
+                                containerRemoved(iterat->second);
                                 containers.erase(iterat);
                             }
                         }
 
+                        itemRemoved(item);
                         it = items.erase(it);
                     }
                 } else {
@@ -679,6 +692,7 @@ void Container::insertIntoFirstFreeSlot(Item &item) {
 
     if (freeSlot < slotCount) {
         items.insert(ITEMMAP::value_type(freeSlot, item));
+        itemAdded(item);
         World::get()->sendContainerSlotChange(this, freeSlot);
     }
 }
@@ -690,17 +704,112 @@ void Container::insertIntoFirstFreeSlot(Item &item, Container *container) {
     if (freeSlot < slotCount) {
         items.insert(ITEMMAP::value_type(freeSlot, item));
         containers.insert(CONTAINERMAP::value_type(freeSlot, container));
+        itemAdded(item);
+        containerAdded(container);
         World::get()->sendContainerSlotChange(this, freeSlot);
     }
 }
 
 TYPE_OF_CONTAINERSLOTS Container::getFirstFreeSlot() const {
     TYPE_OF_CONTAINERSLOTS slotCount = getSlotCount();
-    TYPE_OF_CONTAINERSLOTS i = 0;
+    TYPE_OF_CONTAINERSLOTS i = items.first_unused();
+
+    if (i < slotCount) {
+        return i;
+    }
+
+    return slotCount;
+}
+
+bool Container::isNestedIn(const Container *container) const {
+    int depth = 0;
+
+    for (const Container *ancestor = parent; ancestor; ancestor = ancestor->parent) {
+        if (ancestor == container || ++depth > MAXIMALEREKURSIONSTIEFE) {
+            return true;
+        }
+    }
+
+    return false;
+}
 
-    while (i < slotCount && items.find(i) != items.end()) {
-        ++i;
+void Container::clearContent() {
+    if (parent) {
+        parent->changeContent(*this, -1);
     }
 
-    return i;
+    for (auto it = containers.begin(); it != containers.end(); ++it) {
+        delete it->second;
+        it->second = nullptr;
+    }
+
+    items.clear();
+    containers.clear();
+    contentWeight = 0;
+    itemCounts.clear();
+}
+
+uint32_t Container::indexedCount(Item::id_type itemid) const {
+    const auto it = itemCounts.find(itemid);
+
+    if (it != itemCounts.end()) {
+        return it->second;
+    }
+
+    return 0;
+}
+
+uint32_t Container::itemWeight(const Item &item) {
+    const auto &itemStruct = Data::Items[item.getId()];
+
+    if (item.isContainer()) {
+        return itemStruct.Weight;
+    }
+
+    return itemStruct.Weight * item.getNumber();
+}
+
+void Container::itemAdded(const Item &item) {
+    changeContent(item.getId(), item.getNumber(), itemWeight(item));
+}
+
+void Container::itemRemoved(const Item &item) {
+    changeContent(item.getId(), -int32_t(item.getNumber()), -int32_t(itemWeight(item)));
+}
+
+void Container::containerAdded(Container *container) {
+    container->parent = this;
+    changeContent(*container, 1);
+}
+
+void Container::containerRemoved(Container *container) {
+    changeContent(*container, -1);
+    container->parent = nullptr;
+}
+
+void Container::changeContent(Item::id_type itemid, int32_t number, int32_t weight) {
+    for (Container *container = this; container; container = container->parent) {
+        container->contentWeight += weight;
+        auto &count = container->itemCounts[itemid];
+        count += number;
+
+        if (count == 0) {
+            container->itemCounts.erase(itemid);
+        }
+    }
+}
+
+void Container::changeContent(const Container &content, int sign) {
+    for (Container *container = this; container; container = container->parent) {
+        container->contentWeight += sign * int32_t(content.contentWeight);
+
+        for (const auto &count : content.itemCounts) {
+            auto &total = container->itemCounts[count.first];
+            total += sign * int32_t(count.second);
+
+            if (total == 0) {
+                container->itemCounts.erase(count.first);
+            }
+        }
+    }
 }
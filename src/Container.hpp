@@ -24,11 +24,12 @@
 
 #include "TableStructs.hpp"
 
-#include <map>
+#include <unordered_map>
 #include <iostream>
 #include <fstream>
 
 #include "Item.hpp"
+#include "dense_map.hpp"
 
 class ItemTable;
 
@@ -36,8 +37,9 @@ class RecursionException : public std::exception {};
 
 class Container {
 public:
-    typedef std::map<TYPE_OF_CONTAINERSLOTS, Item> ITEMMAP;
-    typedef std::map<TYPE_OF_CONTAINERSLOTS, Container *> CONTAINERMAP;
+    // slots are bounded by getSlotCount(), so they are kept in flat arrays indexed by slot
+    typedef dense_map<TYPE_OF_CONTAINERSLOTS, Item> ITEMMAP;
+    typedef dense_map<TYPE_OF_CONTAINERSLOTS, Container *> CONTAINERMAP;
 
 private:
     Item::id_type itemId;
@@ -45,6 +47,13 @@ private:
     ITEMMAP items;
     CONTAINERMAP containers;
 
+    // aggregates over all items, including those in nested containers,
+    // kept up to date by every change and passed on to the parent container
+    Container *parent = nullptr;
+    uint32_t contentWeight = 0;
+    uint32_t weightGeneration = 0;
+    std::unordered_map<Item::id_type, uint32_t> itemCounts;
+
 public:
     Container(Item::id_type itemId);
     Container(const Container &source);
@@ -105,7 +114,17 @@ private:
     bool isItemStackable(Item item);
     void insertIntoFirstFreeSlot(Item &item);
     void insertIntoFirstFreeSlot(Item &item, Container *container);
-    int recursiveWeight(int rekt);
+    bool isNestedIn(const Container *container) const;
+    void clearContent();
+    uint32_t indexedCount(Item::id_type itemid) const;
+    uint32_t recalculateWeight();
+    static uint32_t itemWeight(const Item &item);
+    void itemAdded(const Item &item);
+    void itemRemoved(const Item &item);
+    void containerAdded(Container *container);
+    void containerRemoved(Container *container);
+    void changeContent(Item::id_type itemid, int32_t number, int32_t weight);
+    void changeContent(const Container &content, int sign);
 };
 
 #endif
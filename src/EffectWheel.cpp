@@ -0,0 +1,32 @@
+//  illarionserver - server for the game Illarion
+//  Copyright 2011 Illarion e.V.
+//
+//  This file is part of illarionserver.
+//
+//  illarionserver is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  illarionserver is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with illarionserver.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "EffectWheel.hpp"
+
+#include <algorithm>
+
+EffectWheel::EffectWheel() : slots(SLOTS) {
+}
+
+EffectWheel::tick_t EffectWheel::schedule(TYPE_OF_CHARACTER_ID character, tick_t due) {
+    due = std::max(due, currentTick + 1);
+    slots[due % SLOTS].push_back({character, due});
+    ++entries;
+    return due;
+}
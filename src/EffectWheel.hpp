@@ -0,0 +1,96 @@
+//  illarionserver - server for the game Illarion
+//  Copyright 2011 Illarion e.V.
+//
+//  This file is part of illarionserver.
+//
+//  illarionserver is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  illarionserver is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with illarionserver.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef _EFFECT_WHEEL_HPP_
+#define _EFFECT_WHEEL_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "types.hpp"
+
+/**
+* world-wide clock of the long time effects and the characters whose effects are due
+*
+* the clock advances once per player cycle. Every character with effects is filed under
+* the tick its next effect is due, so a tick only visits characters with due effects.
+* The wheel is hashed: entries due more than one revolution ahead wait in their slot and
+* are skipped until their round comes. Entries are never removed, visitors have to ignore
+* characters which are gone or were filed again for another tick.
+*/
+class EffectWheel {
+public:
+    typedef int32_t tick_t;
+
+    EffectWheel();
+
+    EffectWheel(const EffectWheel &) = delete;
+    EffectWheel &operator=(const EffectWheel &) = delete;
+
+    tick_t now() const {
+        return currentTick;
+    }
+
+    // files character under due, but at least under the next tick, returns the tick used
+    tick_t schedule(TYPE_OF_CHARACTER_ID character, tick_t due);
+
+    // advances the clock by one tick and calls visit for every character filed under it
+    template<class Visitor> void advance(Visitor visit) {
+        ++currentTick;
+        auto &slot = slots[currentTick % SLOTS];
+        dueCharacters.clear();
+        size_t kept = 0;
+
+        for (const auto &entry : slot) {
+            if (entry.due <= currentTick) {
+                dueCharacters.push_back(entry.character);
+            } else {
+                slot[kept++] = entry;
+            }
+        }
+
+        slot.resize(kept);
+        entries -= dueCharacters.size();
+
+        for (const auto character : dueCharacters) {
+            visit(character);
+        }
+    }
+
+    // number of filed entries, including outdated ones
+    size_t size() const {
+        return entries;
+    }
+
+private:
+    static constexpr tick_t SLOTS = 4096;
+
+    struct Entry {
+        TYPE_OF_CHARACTER_ID character;
+        tick_t due;
+    };
+
+    std::vector<std::vector<Entry>> slots;
+    std::vector<TYPE_OF_CHARACTER_ID> dueCharacters;
+    tick_t currentTick = 0;
+    size_t entries = 0;
+};
+
+#endif
@@ -92,6 +92,18 @@ ScriptItem Field::getStackItem(uint8_t pos) const {
     return {};
 }
 
+bool Field::hasViewBlockingItem() const {
+    return viewBlocker > 0;
+}
+
+ScriptItem Field::getViewBlockingItem() const {
+    if (viewBlocker > 0) {
+        return getStackItem(viewBlocker - 1);
+    }
+
+    return {};
+}
+
 const std::vector<Item> &Field::getItemStack() const {
     return items;
 }
@@ -214,7 +226,7 @@ bool Field::addContainerOnStackIfWalkable(Item item, Container *container) {
                         container = new Container(item.getId());
                     }
 
-                    containers.insert(iterat, Container::CONTAINERMAP::value_type(count, container));
+                    containers.insert(iterat, decltype(containers)::value_type(count, container));
                 } else {
                     return false;
                 }
@@ -249,7 +261,7 @@ bool Field::addContainerOnStack(Item item, Container *container) {
                 container = new Container(item.getId());
             }
 
-            containers.insert(iterat, Container::CONTAINERMAP::value_type(count, container));
+            containers.insert(iterat, decltype(containers)::value_type(count, container));
         } else {
             return false;
         }
@@ -428,12 +440,28 @@ int8_t Field::age() {
         }
     }
 
-    updateFlags();
+    if (ret != 0) {
+        updateFlags();
+    }
 
     return ret;
 
 }
 
+bool Field::isAgeing() const {
+    if (!containers.empty()) {
+        return true;
+    }
+
+    for (const auto &item : items) {
+        if (!item.isPermanent()) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void Field::updateFlags() {
 
     unsetBits(FLAG_SPECIALITEM | FLAG_BLOCKPATH | FLAG_MAKEPASSABLE);
@@ -443,7 +471,19 @@ void Field::updateFlags() {
         setBits(tt.flags & FLAG_BLOCKPATH);
     }
 
-    for (const auto &item : items) {
+    viewBlocker = 0;
+    TYPE_OF_VOLUME largestVolume = 0;
+
+    for (size_t i = 0; i < items.size(); ++i) {
+        const auto &item = items[i];
+        const auto volume = item.getVolume();
+
+        // the largest item decides whether the field can be seen through
+        if (volume > largestVolume) {
+            largestVolume = volume;
+            viewBlocker = item.isLarge() ? i + 1 : 0;
+        }
+
         if (Data::TilesModItems.exists(item.getId())) {
             const auto &mod = Data::TilesModItems[item.getId()];
             setBits(mod.Modificator & FLAG_SPECIALITEM);
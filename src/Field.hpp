@@ -20,6 +20,7 @@
 #ifndef _FIELD_HPP_
 #define _FIELD_HPP_
 
+#include <map>
 #include <vector>
 #include <sys/socket.h>
 
@@ -38,11 +39,13 @@ private:
     uint16_t tile = 0;
     uint16_t music = 0;
     uint8_t flags = 0;
+    // 1 + stack position of the largest item if it blocks the line of sight, 0 otherwise
+    uint8_t viewBlocker = 0;
     position warptarget;
     std::vector<Item> items;
 
 public:
-    Container::CONTAINERMAP containers;
+    std::map<TYPE_OF_CONTAINERSLOTS, Container *> containers;
 
 public:
     void setTileId(uint16_t id);
@@ -66,6 +69,8 @@ public:
     bool swapItemOnStack(TYPE_OF_ITEM_ID newid, uint16_t newQuality = 0);
     bool viewItemOnStack(Item &item) const;
     ScriptItem getStackItem(uint8_t spos) const;
+    bool hasViewBlockingItem() const;
+    ScriptItem getViewBlockingItem() const;
     const std::vector<Item> &getItemStack() const;
     MAXCOUNTTYPE itemCount() const;
 
@@ -73,6 +78,8 @@ public:
     bool addContainerOnStack(Item item, Container *container);
 
     int8_t age();
+    // true if ageing might change the field, i.e. it holds items that rot or containers
+    bool isAgeing() const;
 
     void setPlayer();
     void setNPC();
@@ -25,8 +25,13 @@
 
 #include "Config.hpp"
 #include "Logger.hpp"
+#include "MetricsServer.hpp"
+#include "Statistics.hpp"
+
+#include "constants.hpp"
 
 #include "netinterface/NetInterface.hpp"
+#include "netinterface/protocol/ServerCommands.hpp"
 
 std::shared_ptr<InitialConnection> InitialConnection::create() {
     std::shared_ptr<InitialConnection> ptr(new InitialConnection());
@@ -37,7 +42,7 @@ std::shared_ptr<InitialConnection> InitialConnection::create() {
 }
 
 
-auto InitialConnection::getNewPlayers() -> NewPlayerVector& {
+auto InitialConnection::getNewPlayers() -> NewPlayerQueue& {
     return newPlayers;
 }
 
@@ -53,17 +58,61 @@ void InitialConnection::run_service() {
     acceptor->async_accept(newConnection->getSocket(),
                            std::bind(&InitialConnection::accept_connection,
                                      shared_from_this(), newConnection, _1));
+    start_metrics();
     Logger::info(LogFacility::Other) << "Starting the IO Service!" << Log::end;
     io_service.run();
 }
 
+void InitialConnection::start_metrics() {
+    using boost::asio::ip::tcp;
+    using Statistic::Statistics;
+
+    Statistics::getInstance().registerGauge("connections_open", [] {
+        return static_cast<double>(NetInterface::getOpenConnections());
+    });
+
+    std::weak_ptr<InitialConnection> weakSelf = shared_from_this();
+    Statistics::getInstance().registerGauge("login_queue", [weakSelf] {
+        auto self = weakSelf.lock();
+        return self ? static_cast<double>(self->newPlayers.size()) : 0.0;
+    });
+
+    uint16_t port = Config::instance().metrics_port;
+
+    if (port == 0) {
+        return;
+    }
+
+    try {
+        auto address = boost::asio::ip::address::from_string(Config::instance().metrics_address);
+        metricsServer = std::make_shared<MetricsServer>(io_service, tcp::endpoint(address, port));
+        metricsServer->start();
+    } catch (std::exception &e) {
+        Logger::error(LogFacility::Other) << "Could not start metrics endpoint: " << e.what() << Log::end;
+    }
+}
+
 void
 InitialConnection::accept_connection(std::shared_ptr<NetInterface> connection,
                                      const boost::system::error_code &error) {
+    using Statistic::Statistics;
+    static const auto connectionsAccepted = Statistics::getInstance().registerCounter("connections_accepted");
+    static const auto loginsRefused = Statistics::getInstance().registerCounter("logins_refused");
+
     if (!error) {
-        if (connection->activate()) {
-            newPlayers.push_back(connection);
-        } else {
+        Statistics::getInstance().increment(connectionsAccepted);
+        auto self = shared_from_this();
+        connection->setLoginHandler([self](const std::shared_ptr<NetInterface> &loggingIn) {
+            // never block the io thread, refuse the login if the login thread cannot keep up
+            if (!self->newPlayers.try_push(loggingIn)) {
+                Statistics::getInstance().increment(loginsRefused);
+                Logger::warn(LogFacility::Other) << "Login queue full, refusing connection from " << loggingIn->getIPAdress() << Log::end;
+                ServerCommandPointer cmd = std::make_shared<LogOutTC>(UNSTABLECONNECTION);
+                loggingIn->shutdownSend(cmd);
+            }
+        });
+
+        if (!connection->activate()) {
             Logger::error(LogFacility::Other)
                 << "Error while activating connection!" << Log::end;
         }
@@ -24,10 +24,12 @@
 
 #include <boost/asio.hpp>
 
-#include "thread_safe_vector.hpp"
+#include "bounded_queue.hpp"
+#include "tuningConstants.hpp"
 #include "Connection.hpp"
 
 class NetInterface;
+class MetricsServer;
 
 #define BACKLOG 10
 
@@ -36,16 +38,20 @@ class InitialConnection
       public std::enable_shared_from_this<InitialConnection> {
 
 public:
-    using NewPlayerVector = thread_safe_vector<std::shared_ptr<NetInterface>>;
+    using NewPlayerQueue = bounded_queue<std::shared_ptr<NetInterface>>;
 
     static std::shared_ptr<InitialConnection> create();
     ~InitialConnection();
 
-    NewPlayerVector &getNewPlayers();
+    /**
+    * connections which have sent their login command and are ready to be logged in
+    */
+    NewPlayerQueue &getNewPlayers();
 
 private:
     InitialConnection() = default;
     void run_service();
+    void start_metrics();
 
     boost::asio::io_service io_service;
     std::unique_ptr<boost::asio::ip::tcp::acceptor> acceptor = nullptr;
@@ -53,7 +59,9 @@ private:
     void accept_connection(std::shared_ptr<NetInterface> connection,
                            const boost::system::error_code &error);
 
-    NewPlayerVector newPlayers;
+    NewPlayerQueue newPlayers{LOGIN_QUEUE_SIZE};
+
+    std::shared_ptr<MetricsServer> metricsServer;
 };
 
 #endif
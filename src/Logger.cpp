@@ -19,15 +19,246 @@
 
 #include "Logger.hpp"
 
-LogType<LogPriority::EMERGENCY>::type Logger::emergency;
-LogType<LogPriority::ALERT>::type Logger::alert;
-LogType<LogPriority::CRITICAL>::type Logger::critical;
-LogType<LogPriority::ERROR>::type Logger::error;
-LogType<LogPriority::WARNING>::type Logger::warn;
-LogType<LogPriority::NOTICE>::type Logger::notice;
-LogType<LogPriority::INFO>::type Logger::info;
-LogType<LogPriority::DEBUG>::type Logger::debug;
-
-void log_message(LogPriority priority, LogFacility facility, const std::string &message) {
-    syslog(static_cast<int>(priority) | static_cast<int>(facility), "%s", message.c_str());
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <mutex>
+#include <thread>
+
+#include "lockfree_queue.hpp"
+#include "tuningConstants.hpp"
+
+thread_local LogType<LogPriority::EMERGENCY>::type Logger::emergency;
+thread_local LogType<LogPriority::ALERT>::type Logger::alert;
+thread_local LogType<LogPriority::CRITICAL>::type Logger::critical;
+thread_local LogType<LogPriority::ERROR>::type Logger::error;
+thread_local LogType<LogPriority::WARNING>::type Logger::warn;
+thread_local LogType<LogPriority::NOTICE>::type Logger::notice;
+thread_local LogType<LogPriority::INFO>::type Logger::info;
+thread_local LogType<LogPriority::DEBUG>::type Logger::debug;
+
+namespace {
+
+struct LogRecord {
+    LogPriority priority = LogPriority::INFO;
+    LogFacility facility = LogFacility::Other;
+    std::chrono::system_clock::time_point time;
+    std::string message;
+};
+
+const char *priorityName(LogPriority priority) {
+    static const char *names[] = {"EMERGENCY", "ALERT", "CRITICAL", "ERROR", "WARNING", "NOTICE", "INFO", "DEBUG"};
+    return names[static_cast<int>(priority) & 7];
+}
+
+const char *facilityName(LogFacility facility) {
+    switch (facility) {
+    case LogFacility::Database:
+        return "database";
+
+    case LogFacility::World:
+        return "world";
+
+    case LogFacility::Script:
+        return "script";
+
+    case LogFacility::Player:
+        return "player";
+
+    case LogFacility::Chat:
+        return "chat";
+
+    case LogFacility::Admin:
+        return "admin";
+
+    default:
+        return "other";
+    }
+}
+
+/**
+* drains the queue of formatted messages in batches on its own thread
+*
+* urgent messages (error and above) wake the writer immediately,
+* everything else is written at the latest after LOG_WRITE_INTERVAL ms
+*/
+class LogWriter {
+public:
+    static LogWriter &getInstance() {
+        // never destroyed, detached threads may log while the process exits
+        static LogWriter *instance = new LogWriter();
+        return *instance;
+    }
+
+    void push(LogRecord &&record) {
+        const bool urgent = static_cast<int>(record.priority) <= static_cast<int>(LogPriority::ERROR);
+
+        if (!queue.try_push(std::move(record))) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        if (urgent) {
+            wakeup.notify_one();
+        }
+    }
+
+    bool setFile(const std::string &path) {
+        std::FILE *newFile = nullptr;
+
+        if (!path.empty()) {
+            newFile = std::fopen(path.c_str(), "a");
+
+            if (!newFile) {
+                return false;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(writeMutex);
+
+        if (file) {
+            std::fclose(file);
+        }
+
+        file = newFile;
+        return true;
+    }
+
+    void flush() {
+        // bounded, producers might never stop
+        const size_t maxBatches = queue.capacity() / LOG_WRITE_BATCH + 1;
+
+        for (size_t i = 0; i < maxBatches && writeBatch() > 0; ++i) {
+        }
+    }
+
+    uint64_t getDropped() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    uint64_t getWritten() const {
+        return written.load(std::memory_order_relaxed);
+    }
+
+private:
+    LogWriter() : queue(LOG_QUEUE_SIZE) {
+        std::thread(&LogWriter::run, this).detach();
+        std::atexit([] { LogWriter::getInstance().flush(); });
+    }
+
+    void run() {
+        uint64_t reportedDrops = 0;
+
+        while (true) {
+            if (writeBatch() < LOG_WRITE_BATCH) {
+                std::unique_lock<std::mutex> lock(wakeupMutex);
+                wakeup.wait_for(lock, std::chrono::milliseconds(LOG_WRITE_INTERVAL));
+            }
+
+            const auto drops = dropped.load(std::memory_order_relaxed);
+
+            if (drops != reportedDrops) {
+                LogRecord record;
+                record.priority = LogPriority::WARNING;
+                record.time = std::chrono::system_clock::now();
+                record.message = "Log queue full, dropped " + std::to_string(drops - reportedDrops) + " messages";
+                reportedDrops = drops;
+
+                std::lock_guard<std::mutex> lock(writeMutex);
+                write(record);
+                finishBatch();
+            }
+        }
+    }
+
+    size_t writeBatch() {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        size_t count = 0;
+
+        while (count < LOG_WRITE_BATCH && queue.try_pop(record)) {
+            write(record);
+            ++count;
+        }
+
+        if (count > 0) {
+            finishBatch();
+            written.fetch_add(count, std::memory_order_relaxed);
+        }
+
+        return count;
+    }
+
+    // all of the following require writeMutex to be held
+    void write(const LogRecord &entry) {
+        if (!file) {
+            syslog(static_cast<int>(entry.priority) | static_cast<int>(entry.facility), "%s", entry.message.c_str());
+            return;
+        }
+
+        const std::time_t time = std::chrono::system_clock::to_time_t(entry.time);
+        std::tm local;
+        localtime_r(&time, &local);
+        char timestamp[32];
+        std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", &local);
+
+        buffer += timestamp;
+        buffer += ' ';
+        buffer += priorityName(entry.priority);
+        buffer += ' ';
+        buffer += facilityName(entry.facility);
+        buffer += ": ";
+        buffer += entry.message;
+        buffer += '\n';
+    }
+
+    void finishBatch() {
+        if (file && !buffer.empty()) {
+            std::fwrite(buffer.data(), 1, buffer.size(), file);
+            std::fflush(file);
+        }
+
+        buffer.clear();
+    }
+
+    lockfree_queue<LogRecord> queue;
+    std::atomic<uint64_t> dropped = {0};
+    std::atomic<uint64_t> written = {0};
+
+    std::mutex wakeupMutex;
+    std::condition_variable wakeup;
+
+    std::mutex writeMutex;
+    std::FILE *file = nullptr;
+    std::string buffer;
+    LogRecord record;
+};
+
+}
+
+void log_message(LogPriority priority, LogFacility facility, std::string message) {
+    LogRecord record;
+    record.priority = priority;
+    record.facility = facility;
+    record.time = std::chrono::system_clock::now();
+    record.message = std::move(message);
+    LogWriter::getInstance().push(std::move(record));
+}
+
+bool Logger::setLogFile(const std::string &path) {
+    return LogWriter::getInstance().setFile(path);
+}
+
+void Logger::flush() {
+    LogWriter::getInstance().flush();
+}
+
+uint64_t Logger::getDroppedMessages() {
+    return LogWriter::getInstance().getDropped();
+}
+
+uint64_t Logger::getWrittenMessages() {
+    return LogWriter::getInstance().getWritten();
 }
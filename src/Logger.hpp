@@ -20,8 +20,10 @@
 #ifndef LOGGER_HPP
 #define LOGGER_HPP
 
+#include <cstdint>
 #include <string>
 #include <sstream>
+#include <utility>
 
 #include <syslog.h>
 
@@ -56,7 +58,11 @@ enum class LogPriority {
     DEBUG = LOG_DEBUG
 };
 
-void log_message(LogPriority priority, LogFacility facility, const std::string &message);
+/**
+* queues the message for the background writer, never blocks
+* messages are dropped if the writer cannot keep up
+*/
+void log_message(LogPriority priority, LogFacility facility, std::string message);
 
 namespace Log {
 class end_t {
@@ -94,8 +100,9 @@ public:
     }
 
     LogStream &operator<<(const Log::end_t &) {
-        log_message(priority, _facility, _ss.str());
+        std::string message = _ss.str();
         _ss.str( {});
+        log_message(priority, _facility, std::move(message));
         return *this;
     }
 
@@ -129,16 +136,34 @@ DEACTIVATE_LOG(LogPriority::NOTICE)
 
 #undef DEACTIVATE_LOG
 
+/**
+* every thread formats into its own streams, the formatted messages
+* are written to syslog or a file by a background thread
+*/
 class Logger {
 public:
-    static LogType<LogPriority::EMERGENCY>::type emergency;
-    static LogType<LogPriority::ALERT>::type alert;
-    static LogType<LogPriority::CRITICAL>::type critical;
-    static LogType<LogPriority::ERROR>::type error;
-    static LogType<LogPriority::WARNING>::type warn;
-    static LogType<LogPriority::NOTICE>::type notice;
-    static LogType<LogPriority::INFO>::type info;
-    static LogType<LogPriority::DEBUG>::type debug;
+    static thread_local LogType<LogPriority::EMERGENCY>::type emergency;
+    static thread_local LogType<LogPriority::ALERT>::type alert;
+    static thread_local LogType<LogPriority::CRITICAL>::type critical;
+    static thread_local LogType<LogPriority::ERROR>::type error;
+    static thread_local LogType<LogPriority::WARNING>::type warn;
+    static thread_local LogType<LogPriority::NOTICE>::type notice;
+    static thread_local LogType<LogPriority::INFO>::type info;
+    static thread_local LogType<LogPriority::DEBUG>::type debug;
+
+    /**
+    * writes messages to the given file instead of syslog
+    * @param path the file to append to, empty to log to syslog
+    * @return false if the file cannot be opened, logging continues to the previous target
+    */
+    static bool setLogFile(const std::string &path);
+
+    // writes all queued messages before returning
+    static void flush();
+
+    // messages dropped because the queue was full
+    static uint64_t getDroppedMessages();
+    static uint64_t getWrittenMessages();
 };
 
 #endif
@@ -33,8 +33,9 @@
 
 #include "LongTimeEffect.hpp"
 #include "Player.hpp"
+#include "World.hpp"
 
-LongTimeCharacterEffects::LongTimeCharacterEffects(Character *owner) : owner(owner), time(0) {
+LongTimeCharacterEffects::LongTimeCharacterEffects(Character *owner) : owner(owner) {
 }
 
 bool LongTimeCharacterEffects::find(uint16_t effectid, LongTimeEffect *&effect) {
@@ -70,9 +71,10 @@ void LongTimeCharacterEffects::addEffect(LongTimeEffect *effect) {
     }
 
     if (!find(effect->getEffectId(), foundeffect)) {
-        effect->setExecutionTime(time);
+        effect->setExecutionTime(World::get()->getEffectWheel().now());
         effects.push_back(effect);
         std::push_heap(effects.begin(), effects.end(), LongTimeEffect::priority);
+        schedule();
 
         if (effect->isFirstAdd()) {
             const auto &script = Data::LongTimeEffects.script(effect->getEffectId());
@@ -150,7 +152,13 @@ bool LongTimeCharacterEffects::removeEffect(LongTimeEffect *effect) {
 }
 
 void LongTimeCharacterEffects::checkEffects() {
-    ++time;
+    const auto time = World::get()->getEffectWheel().now();
+
+    if (!scheduled || scheduledFor != time) {
+        return;
+    }
+
+    scheduled = false;
     int emexit = 0;
 
     while (!effects.empty() && (emexit < 200) && (effects.front()->getExecutionTime() <= time)) {
@@ -169,6 +177,59 @@ void LongTimeCharacterEffects::checkEffects() {
             }
         }
     }
+
+    schedule();
+}
+
+void LongTimeCharacterEffects::delayEffects() {
+    if (scheduled && scheduledFor == World::get()->getEffectWheel().now()) {
+        scheduled = false;
+        schedule();
+    }
+}
+
+void LongTimeCharacterEffects::activate() {
+    if (active) {
+        return;
+    }
+
+    active = true;
+    const auto now = World::get()->getEffectWheel().now();
+
+    for (const auto &effect : effects) {
+        effect->setExecutionTime(now);
+    }
+
+    std::make_heap(effects.begin(), effects.end(), LongTimeEffect::priority);
+
+    for (const auto &effect : effects) {
+        const auto &script = Data::LongTimeEffects.script(effect->getEffectId());
+
+        if (script) {
+            script->loadEffect(effect, owner);
+        }
+    }
+
+    schedule();
+}
+
+void LongTimeCharacterEffects::prepareSave() {
+    saveTime = active ? World::get()->getEffectWheel().now() : 0;
+}
+
+void LongTimeCharacterEffects::schedule() {
+    if (effects.empty() || !owner || !active) {
+        return;
+    }
+
+    auto &wheel = World::get()->getEffectWheel();
+    const auto due = effects.front()->getExecutionTime();
+
+    // a tick already passed means the owner was not found when it was visited
+    if (!scheduled || due < scheduledFor || scheduledFor <= wheel.now()) {
+        scheduledFor = wheel.schedule(owner->getId(), due);
+        scheduled = true;
+    }
 }
 
 bool LongTimeCharacterEffects::save() {
@@ -210,13 +271,13 @@ bool LongTimeCharacterEffects::save() {
     bool allok = true;
 
     for (auto it = effects.begin(); it != effects.end(); ++it) {
-        allok and_eq(*it)->save(player->getId(), time);
+        allok and_eq(*it)->save(player->getId(), saveTime);
     }
 
     return allok;
 }
 
-bool LongTimeCharacterEffects::load() {
+bool LongTimeCharacterEffects::load(const Database::PConnection &connection) {
     using namespace Database;
 
     if (owner->getType() != Character::player) {
@@ -225,8 +286,6 @@ bool LongTimeCharacterEffects::load() {
 
     Player *player = dynamic_cast<Player *>(owner);
 
-    PConnection connection = ConnectionManager::getInstance().getConnection();
-
     try {
         SelectQuery query(connection);
         query.addColumn("playerlteffects", "plte_effectid");
@@ -241,9 +300,16 @@ bool LongTimeCharacterEffects::load() {
         if (!results.empty()) {
             for (const auto &row : results) {
                 uint16_t effectId = row["plte_effectid"].as<uint16_t>();
+
+                // the table's operator[] is not safe to use from several loading threads
+                if (!Data::LongTimeEffects.exists(effectId)) {
+                    Logger::warn(LogFacility::Database) << "Dropping unknown long time effect " << effectId << " of " << player->to_string() << Log::end;
+                    continue;
+                }
+
                 LongTimeEffect *effect = new LongTimeEffect(effectId, row["plte_nextcalled"].as<int32_t>());
 
-                effect->setExecutionTime(time);
+                effect->setExecutionTime(0);
                 effect->firstAdd();
                 effect->setNumberOfCalls(row["plte_numberCalled"].as<uint32_t>());
 
@@ -265,16 +331,9 @@ bool LongTimeCharacterEffects::load() {
                 }
 
                 effects.push_back(effect);
-                const auto &script = Data::LongTimeEffects.script(effectId);
-
-                if (script) {
-                    script->loadEffect(effect, player);
-                }
             }
         }
 
-        std::make_heap(effects.begin(), effects.end(), LongTimeEffect::priority);
-
         return true;
     } catch (std::exception &e) {
         Logger::error(LogFacility::Database) << "Error while loading long time effects for " << player->to_string() << ": " << e.what() << Log::end;
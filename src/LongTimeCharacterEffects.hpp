@@ -24,6 +24,9 @@
 #include <string>
 #include <vector>
 
+#include "EffectWheel.hpp"
+#include "db/Connection.hpp"
+
 class LongTimeEffect;
 class Character;
 
@@ -39,17 +42,44 @@ public:
     bool removeEffect(LongTimeEffect *effect);
 
     void push_backEffect(LongTimeEffect *effect);
+
+    /**
+    * runs the effects due now, called by the world for characters filed in its effect wheel
+    * does nothing if the character is filed for another tick
+    */
     void checkEffects();
+
+    // keeps the due effects for the next tick, e.g. while the owner is dead
+    void delayEffects();
+
+    /**
+    * files the effects read by load in the effect wheel
+    * called on the game thread once the owner entered the world
+    */
+    void activate();
+
+    // remembers the current tick for save, called on the game thread before the owner is handed to the save thread
+    void prepareSave();
+
     bool save();
-    bool load();
+    // only reads the effects, runs on the player loading threads
+    bool load(const Database::PConnection &connection);
 
 private:
+    // files the owner in the effect wheel if its next effect is due before it is filed
+    void schedule();
+
     typedef std::vector<LongTimeEffect *> EFFECTS;
     EFFECTS effects;
 
     Character *owner;
 
-    int32_t time;
+    bool scheduled = false;
+    EffectWheel::tick_t scheduledFor = 0;
+
+    // execution times are relative to the tick of activation until activate is called
+    bool active = false;
+    EffectWheel::tick_t saveTime = 0;
 };
 
 #endif
@@ -22,6 +22,9 @@
 
 #include <sstream>
 #include <iostream>
+#include <unordered_map>
+#include <deque>
+#include <mutex>
 
 #include <boost/cstdint.hpp>
 
@@ -54,16 +57,88 @@ bool LongTimeEffect::callEffect(Character *target) {
     return ret;
 }
 
+namespace {
+
+// effects are loaded and saved on the player threads, the deque keeps returned names valid while it grows
+std::mutex valueNamesMutex;
+std::unordered_map<std::string, uint16_t> valueKeys;
+std::deque<std::string> valueNames;
+
+}
+
+LongTimeEffect::value_key_t LongTimeEffect::internValueName(const std::string &name) {
+    std::lock_guard<std::mutex> lock(valueNamesMutex);
+    const auto it = valueKeys.find(name);
+
+    if (it != valueKeys.end()) {
+        return it->second;
+    }
+
+    const auto key = static_cast<value_key_t>(valueNames.size());
+    valueNames.push_back(name);
+    valueKeys.emplace(name, key);
+    return key;
+}
+
+bool LongTimeEffect::findValueKey(const std::string &name, value_key_t &key) {
+    std::lock_guard<std::mutex> lock(valueNamesMutex);
+    const auto it = valueKeys.find(name);
+
+    if (it == valueKeys.end()) {
+        return false;
+    }
+
+    key = it->second;
+    return true;
+}
+
+const std::string &LongTimeEffect::valueName(value_key_t key) {
+    std::lock_guard<std::mutex> lock(valueNamesMutex);
+    return valueNames[key];
+}
+
+LongTimeEffect::VALUES::iterator LongTimeEffect::locateValue(value_key_t key) {
+    for (auto it = values.begin(); it != values.end(); ++it) {
+        if (it->first == key) {
+            return it;
+        }
+    }
+
+    return values.end();
+}
+
 void LongTimeEffect::addValue(const std::string &name, uint32_t value) {
-    values[name] = value;
+    const auto key = internValueName(name);
+    const auto it = locateValue(key);
+
+    if (it != values.end()) {
+        it->second = value;
+    } else {
+        values.emplace_back(key, value);
+    }
 }
 
 void LongTimeEffect::removeValue(const std::string &name) {
-    values.erase(name);
+    value_key_t key;
+
+    if (findValueKey(name, key)) {
+        const auto it = locateValue(key);
+
+        if (it != values.end()) {
+            *it = values.back();
+            values.pop_back();
+        }
+    }
 }
 
 bool LongTimeEffect::findValue(const std::string &name, uint32_t &ret) {
-    auto it = values.find(name);
+    value_key_t key;
+
+    if (!findValueKey(name, key)) {
+        return false;
+    }
+
+    const auto it = locateValue(key);
 
     if (it != values.end()) {
         ret = it->second;
@@ -103,7 +178,7 @@ bool LongTimeEffect::save(uint32_t playerid, int32_t currentTime) {
             const InsertQuery::columnIndex valueColumn = insQuery.addColumn("pev_value");
 
             for (const auto &value : values) {
-                insQuery.addValue(nameColumn, value.first);
+                insQuery.addValue(nameColumn, valueName(value.first));
                 insQuery.addValue(valueColumn, value.second);
                 insQuery.addValue(userColumn, playerid);
                 insQuery.addValue(effectColumn, effectId);
@@ -23,7 +23,9 @@
 
 
 #include <string>
-#include <unordered_map>
+#include <vector>
+#include <utility>
+#include <cstdint>
 
 class Character;
 class Player;
@@ -66,8 +68,15 @@ private:
     uint32_t numberOfCalls = 0;
     bool firstadd = true;
 
-    typedef std::unordered_map<std::string, uint32_t> VALUES;
+    // value names are interned world-wide, effects only hold a few values each
+    typedef uint16_t value_key_t;
+    typedef std::vector<std::pair<value_key_t, uint32_t>> VALUES;
     VALUES values;
+
+    static value_key_t internValueName(const std::string &name);
+    static bool findValueKey(const std::string &name, value_key_t &key);
+    static const std::string &valueName(value_key_t key);
+    VALUES::iterator locateValue(value_key_t key);
 };
 
 struct LTEPriority {
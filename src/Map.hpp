@@ -53,8 +53,6 @@ public:
     Field &walkableNear(int16_t &x, int16_t &y);
     const Field &walkableNear(int16_t &x, int16_t &y) const;
 
-    void age();
-
     int16_t getMinX() const;
     int16_t getMinY() const;
     int16_t getMaxX() const;
@@ -0,0 +1,83 @@
+//  illarionserver - server for the game Illarion
+//  Copyright 2011 Illarion e.V.
+//
+//  This file is part of illarionserver.
+//
+//  illarionserver is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  illarionserver is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with illarionserver.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "MessageGarbler.hpp"
+
+#include <algorithm>
+
+#include "Random.hpp"
+
+MessageGarbler::MessageGarbler(const std::string &message)
+    : message(message), length(std::min(message.find('\0'), message.size())) {
+}
+
+const std::string &MessageGarbler::forSkill(int languageSkill) {
+    if (languageSkill >= maxRoll || length == 0) {
+        return message;
+    }
+
+    const auto it = versions.find(languageSkill);
+
+    if (it != versions.end()) {
+        return it->second;
+    }
+
+    roll();
+
+    std::string &garbled = versions[languageSkill];
+    garbled = message;
+
+    const int skill = std::max(languageSkill, -1);
+    const uint8_t *rolled = rolls.data();
+    char *characters = &garbled[0];
+
+    for (size_t i = 0; i < length; ++i) {
+        characters[i] = rolled[i] > skill ? '*' : characters[i];
+    }
+
+    return garbled;
+}
+
+std::string MessageGarbler::garble(const std::string &message, int languageSkill) {
+    MessageGarbler garbler(message);
+    return garbler.forSkill(languageSkill);
+}
+
+void MessageGarbler::roll() {
+    if (!rolls.empty()) {
+        return;
+    }
+
+    // four 16 bit lanes per random word, each scaled down to [0, maxRoll]
+    const size_t words = (length + 3) / 4;
+    rolls.resize(words * 4);
+
+    uint64_t bits[32];
+
+    for (size_t first = 0; first < words; first += 32) {
+        const size_t count = std::min(words - first, size_t(32));
+        Random::fill(bits, count);
+
+        for (size_t word = 0; word < count; ++word) {
+            for (size_t lane = 0; lane < 4; ++lane) {
+                rolls[(first + word) * 4 + lane] = ((bits[word] >> (16 * lane) & 0xffff) * (maxRoll + 1)) >> 16;
+            }
+        }
+    }
+}
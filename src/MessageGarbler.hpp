@@ -0,0 +1,59 @@
+//  illarionserver - server for the game Illarion
+//  Copyright 2011 Illarion e.V.
+//
+//  This file is part of illarionserver.
+//
+//  illarionserver is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  illarionserver is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with illarionserver.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef _MESSAGE_GARBLER_HPP_
+#define _MESSAGE_GARBLER_HPP_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+* garbles a spoken message for all listeners of one broadcast
+*
+* every character is replaced by '*' if its roll in [0, 70] exceeds the
+* listener's language skill; rolls are drawn once per message and in bulk,
+* so listeners with the same skill share one garbled version and a better
+* skill never garbles a character that a worse skill left intact
+*/
+class MessageGarbler {
+public:
+    // message has to outlive the garbler
+    explicit MessageGarbler(const std::string &message);
+
+    MessageGarbler(const MessageGarbler &) = delete;
+    MessageGarbler &operator=(const MessageGarbler &) = delete;
+
+    const std::string &forSkill(int languageSkill);
+
+    static std::string garble(const std::string &message, int languageSkill);
+
+private:
+    static constexpr int maxRoll = 70;
+
+    void roll();
+
+    const std::string &message;
+    size_t length;
+    std::vector<uint8_t> rolls;
+    std::unordered_map<int, std::string> versions;
+};
+
+#endif
@@ -0,0 +1,229 @@
+//  illarionserver - server for the game Illarion
+//  Copyright 2011 Illarion e.V.
+//
+//  This file is part of illarionserver.
+//
+//  illarionserver is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  illarionserver is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with illarionserver.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "MetricsServer.hpp"
+
+#include <cctype>
+#include <chrono>
+#include <sstream>
+
+#include <boost/asio/steady_timer.hpp>
+
+#include "Logger.hpp"
+#include "Statistics.hpp"
+#include "script/LuaProfiler.hpp"
+
+namespace {
+
+// upper bounds of the exported histogram buckets in microseconds
+const uint64_t bucketBounds[] = {
+    100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000,
+    100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000
+};
+
+// only the most expensive script entrypoints are exported
+const size_t luaProfileLimit = 50;
+
+const size_t maxRequestSize = 8192;
+const auto requestTimeout = std::chrono::seconds(5);
+
+std::string metricName(const std::string &name) {
+    std::string result = "illarion_";
+
+    for (char c : name) {
+        result += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+    }
+
+    return result;
+}
+
+std::string labelValue(const std::string &value) {
+    std::string result;
+
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            result += '\\';
+            result += c;
+        } else if (c == '\n') {
+            result += "\\n";
+        } else {
+            result += c;
+        }
+    }
+
+    return result;
+}
+
+class MetricsSession : public std::enable_shared_from_this<MetricsSession> {
+public:
+    explicit MetricsSession(boost::asio::io_service &io_service) : socket(io_service), timer(io_service), request(maxRequestSize) {
+    }
+
+    boost::asio::ip::tcp::socket &getSocket() {
+        return socket;
+    }
+
+    void start() {
+        auto self = shared_from_this();
+
+        timer.expires_from_now(requestTimeout);
+        timer.async_wait([self](const boost::system::error_code &error) {
+            if (!error) {
+                boost::system::error_code ignored;
+                self->socket.close(ignored);
+            }
+        });
+
+        boost::asio::async_read_until(socket, request, "\r\n\r\n", [self](const boost::system::error_code &error, size_t) {
+            self->handleRequest(error);
+        });
+    }
+
+private:
+    void handleRequest(const boost::system::error_code &error) {
+        if (error) {
+            timer.cancel();
+            return;
+        }
+
+        std::istream requestStream(&request);
+        std::string method;
+        std::string path;
+        requestStream >> method >> path;
+
+        if (method == "GET" && (path == "/metrics" || path == "/")) {
+            respond("200 OK", "text/plain; version=0.0.4", MetricsServer::render());
+        } else {
+            respond("404 Not Found", "text/plain", "not found\n");
+        }
+    }
+
+    void respond(const std::string &status, const std::string &contentType, const std::string &body) {
+        std::ostringstream out;
+        out << "HTTP/1.1 " << status << "\r\n"
+            << "Content-Type: " << contentType << "\r\n"
+            << "Content-Length: " << body.size() << "\r\n"
+            << "Connection: close\r\n\r\n"
+            << body;
+        response = out.str();
+
+        auto self = shared_from_this();
+        boost::asio::async_write(socket, boost::asio::buffer(response), [self](const boost::system::error_code &, size_t) {
+            boost::system::error_code ignored;
+            self->socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignored);
+            self->socket.close(ignored);
+            self->timer.cancel();
+        });
+    }
+
+    boost::asio::ip::tcp::socket socket;
+    boost::asio::steady_timer timer;
+    boost::asio::streambuf request;
+    std::string response;
+};
+
+}
+
+MetricsServer::MetricsServer(boost::asio::io_service &io_service, const boost::asio::ip::tcp::endpoint &endpoint)
+    : io_service(io_service), acceptor(io_service, endpoint) {
+}
+
+void MetricsServer::start() {
+    Logger::info(LogFacility::Other) << "Serving metrics on " << acceptor.local_endpoint().address().to_string()
+                                     << ":" << acceptor.local_endpoint().port() << Log::end;
+    accept();
+}
+
+void MetricsServer::accept() {
+    auto session = std::make_shared<MetricsSession>(io_service);
+    auto self = shared_from_this();
+
+    acceptor.async_accept(session->getSocket(), [self, session](const boost::system::error_code &error) {
+        if (!error) {
+            session->start();
+        } else if (error == boost::asio::error::operation_aborted) {
+            return;
+        } else {
+            Logger::error(LogFacility::Other) << "Could not accept metrics connection: " << error.message() << Log::end;
+        }
+
+        self->accept();
+    });
+}
+
+std::string MetricsServer::render() {
+    using Statistic::Histogram;
+    auto &statistics = Statistic::Statistics::getInstance();
+    std::ostringstream out;
+
+    out << "# HELP illarion_duration_seconds Duration of timed server operations.\n"
+        << "# TYPE illarion_duration_seconds histogram\n";
+
+    for (const auto &histogram : statistics.getHistograms()) {
+        const auto name = labelValue(histogram.name);
+        uint64_t cumulative = 0;
+        size_t bucket = 0;
+
+        for (const auto bound : bucketBounds) {
+            // only buckets which lie completely below the bound are counted,
+            // upper bounds are exclusive and in whole microseconds
+            while (bucket < histogram.buckets.size() && Histogram::upperBound(bucket) <= bound + 1) {
+                cumulative += histogram.buckets[bucket++];
+            }
+
+            out << "illarion_duration_seconds_bucket{name=\"" << name << "\",le=\"" << bound / 1e6 << "\"} " << cumulative << "\n";
+        }
+
+        out << "illarion_duration_seconds_bucket{name=\"" << name << "\",le=\"+Inf\"} " << histogram.count << "\n"
+            << "illarion_duration_seconds_sum{name=\"" << name << "\"} " << histogram.sum / 1e6 << "\n"
+            << "illarion_duration_seconds_count{name=\"" << name << "\"} " << histogram.count << "\n";
+    }
+
+    for (const auto &counter : statistics.getCounters()) {
+        const auto name = metricName(counter.first) + "_total";
+        out << "# TYPE " << name << " counter\n"
+            << name << " " << counter.second << "\n";
+    }
+
+    for (const auto &gauge : statistics.getGauges()) {
+        const auto name = metricName(gauge.first);
+        out << "# TYPE " << name << " gauge\n"
+            << name << " " << gauge.second << "\n";
+    }
+
+    const auto luaProfiles = LuaProfiler::getInstance().getTop(luaProfileLimit);
+
+    if (!luaProfiles.empty()) {
+        std::ostringstream calls;
+        std::ostringstream seconds;
+        std::ostringstream allocated;
+
+        for (const auto &profile : luaProfiles) {
+            const auto labels = "{script=\"" + labelValue(profile.script) + "\",entrypoint=\"" + labelValue(profile.entrypoint) + "\"} ";
+            calls << "illarion_lua_calls_total" << labels << profile.time.count << "\n";
+            seconds << "illarion_lua_seconds_total" << labels << profile.time.sum / 1e6 << "\n";
+            allocated << "illarion_lua_allocated_bytes_total" << labels << profile.allocated << "\n";
+        }
+
+        out << "# TYPE illarion_lua_calls_total counter\n" << calls.str()
+            << "# TYPE illarion_lua_seconds_total counter\n" << seconds.str()
+            << "# TYPE illarion_lua_allocated_bytes_total counter\n" << allocated.str();
+    }
+
+    return out.str();
+}
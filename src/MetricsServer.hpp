@@ -0,0 +1,51 @@
+//  illarionserver - server for the game Illarion
+//  Copyright 2011 Illarion e.V.
+//
+//  This file is part of illarionserver.
+//
+//  illarionserver is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  illarionserver is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with illarionserver.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef _METRICS_SERVER_HPP_
+#define _METRICS_SERVER_HPP_
+
+#include <memory>
+#include <string>
+
+#include <boost/asio.hpp>
+
+/**
+* minimal http server answering GET /metrics with the server statistics
+* in the Prometheus text exposition format
+*
+* runs on the io service of the game connections and never touches world state,
+* everything is read from Statistic::Statistics
+*/
+class MetricsServer : public std::enable_shared_from_this<MetricsServer> {
+public:
+    MetricsServer(boost::asio::io_service &io_service, const boost::asio::ip::tcp::endpoint &endpoint);
+
+    void start();
+
+    // renders all histograms, counters and gauges
+    static std::string render();
+
+private:
+    void accept();
+
+    boost::asio::io_service &io_service;
+    boost::asio::ip::tcp::acceptor acceptor;
+};
+
+#endif
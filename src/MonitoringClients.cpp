@@ -82,7 +82,7 @@ void MonitoringClients::CheckClients() {
                 (*it)->Connection->closeConnection();
             }
         } else {
-            PlayerManager::get().getLogOutPlayers().push_back(*it);
+            PlayerManager::get().logoutPlayer(*it);
             it = client_list.erase(it);
             --it;
         }
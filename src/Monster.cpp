@@ -63,12 +63,42 @@ void Monster::performStep(position targetpos) {
     }
 
     if (!waypoints.makeMove()) {
-        direction dir = static_cast<direction>(Random::uniform(0, 7));
-        move(dir);
-        increaseActionPoints(-20);
+        performRandomStep();
     }
 }
 
+void Monster::performStep(position targetpos, std::list<direction> &&steps) {
+    waypoints.clear();
+    waypoints.addWaypoint(targetpos);
+    waypoints.setStepList(std::move(steps));
+
+    if (!waypoints.makeMove()) {
+        performRandomStep();
+    }
+}
+
+void Monster::performRandomStep() {
+    direction dir = static_cast<direction>(Random::uniform(0, 7));
+    move(dir);
+    increaseActionPoints(-20);
+}
+
+void Monster::sleep(int ap) {
+    sleepingAP += ap;
+    ++sleepingCycles;
+}
+
+void Monster::catchUp() {
+    if (sleepingCycles == 0) {
+        return;
+    }
+
+    increaseActionPoints(sleepingAP);
+    increaseFightPoints(sleepingAP);
+    sleepingAP = 0;
+    sleepingCycles = 0;
+}
+
 void Monster::setMonsterType(TYPE_OF_CHARACTER_ID type) {
     deleteAllSkills();
 
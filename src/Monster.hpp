@@ -22,6 +22,7 @@
 
 #include "data/MonsterTable.hpp"
 #include "Character.hpp"
+#include "tuningConstants.hpp"
 
 class SpawnPoint;
 
@@ -116,6 +117,24 @@ public:
     *@param targetpos targetposition for the move;
     */
     void performStep(position targetpos);
+    // same as above, but with a path to targetpos that has already been found
+    void performStep(position targetpos, std::list<direction> &&steps);
+
+    /**
+    * skips a turn of a monster without players nearby, the actionpoints are kept
+    * and given to the monster on the next catchUp, its effects keep running
+    * @param ap actionpoints of the skipped turn
+    */
+    void sleep(int ap);
+
+    bool needsCatchUp() const {
+        return sleepingCycles >= MONSTER_SLEEP_INTERVAL;
+    }
+
+    /**
+    * hands out actionpoints and fightpoints gathered while asleep
+    */
+    void catchUp();
 
     /**
     * destructor
@@ -139,11 +158,14 @@ protected:
     Monster() {};
 
 private:
+    void performRandomStep();
 
     static uint32_t counter;
     SpawnPoint *spawn = nullptr;
     TYPE_OF_CHARACTER_ID monstertype;
     bool _canAttack;
+    int sleepingAP = 0;
+    int sleepingCycles = 0;
 };
 
 #endif // MONSTER_HPP
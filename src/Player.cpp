@@ -69,7 +69,7 @@
 extern std::shared_ptr<LuaPlayerDeathScript>playerDeathScript;
 extern std::shared_ptr<LuaDepotScript>depotScript;
 
-Player::Player(std::shared_ptr<NetInterface> newConnection)
+Player::Player(std::shared_ptr<NetInterface> newConnection, const Database::PConnection &dbConnection)
     : Character(), onlinetime(0), Connection(newConnection), turtleActive(false),
       clippingActive(true), admin(false), questWriteLock(false), monitoringClient(false), dialogCounter(0) {
     screenwidth = 0;
@@ -86,14 +86,14 @@ Player::Player(std::shared_ptr<NetInterface> newConnection)
     setName(loginCommand->getLoginName());
     pw = loginCommand->getPassword();
 
-    check_logindata();
+    check_logindata(dbConnection);
 
     if (status == 7) {
         Logger::error(LogFacility::Player) << to_string() << " did not select a skill package" << Log::end;
         throw LogoutException(NOSKILLS);
     }
 
-    if (!loadGMFlags()) {
+    if (!loadGMFlags(dbConnection)) {
         Logger::error(LogFacility::Player) << "Failed to load gm flags for " << to_string() << Log::end;
         throw LogoutException(UNSTABLECONNECTION);
     }
@@ -119,9 +119,14 @@ Player::Player(std::shared_ptr<NetInterface> newConnection)
 #endif
 
     // now load inventory...
-    if (!load()) {
+    if (!load(dbConnection)) {
         throw LogoutException(CORRUPTDATA);
     }
+
+    // the effects are filed in the world's effect wheel by login on the game thread
+    if (!monitoringClient) {
+        effects.load(dbConnection);
+    }
 }
 
 void Player::login() {
@@ -153,7 +158,7 @@ void Player::login() {
     cmd = std::make_shared<SetCoordinateTC>(pos);
     Connection->addCommand(cmd);
 
-    effects.load();
+    effects.activate();
 
     //send the basic data to the monitoring client
     cmd = std::make_shared<BBPlayerTC>(getId(), getName(), pos);
@@ -218,6 +223,14 @@ unsigned short int Player::getScreenRange() const {
     return (screenwidth > screenheight) ? 2*screenwidth : 2*screenheight;
 }
 
+bool Player::isFieldInView(const position &pos) const {
+    const auto &ownPos = getPosition();
+    // the map of other levels is shifted by three fields per level for perspective
+    const int range = getScreenRange() + 3 * RANGEUP;
+
+    return abs(pos.x - ownPos.x) <= range && abs(pos.y - ownPos.y) <= range && abs(pos.z - ownPos.z) <= RANGEUP;
+}
+
 void Player::setAlive(bool alive) {
     bool wasAlive = isAlive();
     Character::setAlive(alive);
@@ -562,7 +575,10 @@ int Player::eraseItem(TYPE_OF_ITEM_ID itemid, int count, script_data_exchangemap
 
     if ((items[ BACKPACK ].getId() != 0) && backPackContents) {
         temp = backPackContents->eraseItem(itemid, temp, data);
-        updateBackPackView();
+
+        if (temp != count) {
+            updateBackPackView();
+        }
     }
 
     if (temp > 0) {
@@ -878,9 +894,7 @@ bool Player::isAdmin() const {
 }
 
 
-void Player::check_logindata() {
-    Database::PConnection connection = Database::ConnectionManager::getInstance().getConnection();
-
+void Player::check_logindata(const Database::PConnection &connection) {
     try {
         Database::SelectQuery charQuery(connection);
         charQuery.addColumn("chars", "chr_playerid");
@@ -1369,10 +1383,10 @@ bool Player::save() noexcept {
     }
 }
 
-bool Player::loadGMFlags() noexcept {
+bool Player::loadGMFlags(const Database::PConnection &connection) noexcept {
     try {
         using namespace Database;
-        SelectQuery query;
+        SelectQuery query(connection);
         query.addColumn("gms", "gm_rights_server");
         query.addEqualCondition<TYPE_OF_CHARACTER_ID>("gms", "gm_charid", getId());
         query.addServerTable("gms");
@@ -1394,19 +1408,18 @@ bool Player::loadGMFlags() noexcept {
     return false;
 }
 
-bool Player::load() noexcept {
+bool Player::load(const Database::PConnection &connection) noexcept {
     std::map<int, Container *> depots, containers;
     std::map<int, Container *>::iterator it;
 
     bool dataOK=true;
 
     using namespace Database;
-    PConnection connection = ConnectionManager::getInstance().getConnection();
 
     try {
 
         {
-            SelectQuery query;
+            SelectQuery query(connection);
             query.addColumn("questprogress", "qpg_questid");
             query.addColumn("questprogress", "qpg_progress");
             query.addColumn("questprogress", "qpg_time");
@@ -1424,7 +1437,7 @@ bool Player::load() noexcept {
         }
 
         {
-            SelectQuery query;
+            SelectQuery query(connection);
             query.addColumn("introduction", "intro_known_player");
             query.addEqualCondition<TYPE_OF_CHARACTER_ID>("introduction", "intro_player", getId());
             query.addServerTable("introduction");
@@ -1437,7 +1450,7 @@ bool Player::load() noexcept {
         }
 
         {
-            SelectQuery query;
+            SelectQuery query(connection);
             query.addColumn("naming", "name_named_player");
             query.addColumn("naming", "name_player_name");
             query.addEqualCondition<TYPE_OF_CHARACTER_ID>("naming", "name_player", getId());
@@ -1452,7 +1465,7 @@ bool Player::load() noexcept {
         }
 
         {
-            SelectQuery query;
+            SelectQuery query(connection);
             query.addColumn("playerskills", "psk_skill_id");
             query.addColumn("playerskills", "psk_value");
             query.addColumn("playerskills", "psk_minor");
@@ -1479,7 +1492,7 @@ bool Player::load() noexcept {
         std::vector<std::string> key;
         std::vector<std::string> value;
         {
-            SelectQuery query;
+            SelectQuery query(connection);
             query.addColumn("playeritem_datavalues", "idv_linenumber");
             query.addColumn("playeritem_datavalues", "idv_key");
             query.addColumn("playeritem_datavalues", "idv_value");
@@ -1507,7 +1520,7 @@ bool Player::load() noexcept {
         std::vector<Item::quality_type> itemquality;
         std::vector<TYPE_OF_CONTAINERSLOTS> itemcontainerslot;
         {
-            SelectQuery query;
+            SelectQuery query(connection);
             query.addColumn("playeritems", "pit_linenumber");
             query.addColumn("playeritems", "pit_in_container");
             query.addColumn("playeritems", "pit_depot");
@@ -1538,7 +1551,7 @@ bool Player::load() noexcept {
         // load depots
         std::vector<uint32_t> depotid;
         {
-            SelectQuery query;
+            SelectQuery query(connection);
             query.setDistinct(true);
             query.addColumn("playeritems", "pit_depot");
             query.addEqualCondition<TYPE_OF_CHARACTER_ID>("playeritems", "pit_playerid", getId());
@@ -1929,6 +1942,7 @@ bool Player::move(direction dir, uint8_t mode) {
                     cmd = std::make_shared<SetCoordinateTC>(getPosition());
                     Connection->addCommand(cmd);
                     sendFullMap();
+                    visibleChars.clear();
                     cont = false;
                 } else {
                     if (mode != RUNNING || (j == 1 && cont)) {
@@ -1950,7 +1964,7 @@ bool Player::move(direction dir, uint8_t mode) {
 
                 if (mode != RUNNING || j == 1 || !cont) {
                     _world->sendCharacterMoveToAllVisiblePlayers(this, mode, walkcost);
-                    _world->sendAllVisibleCharactersToPlayer(this, true);
+                    _world->sendVisibleCharacterChangesToPlayer(this);
                 }
 
                 if (newField.isWarp()) {
@@ -1979,7 +1993,7 @@ bool Player::move(direction dir, uint8_t mode) {
                 Connection->addCommand(cmd);
                 sendStepStripes(dir);
                 _world->sendCharacterMoveToAllVisiblePlayers(this, mode, walkcost);
-                _world->sendAllVisibleCharactersToPlayer(this, true);
+                _world->sendVisibleCharacterChangesToPlayer(this);
                 return true;
             } else if (j == 0) {
                 ServerCommandPointer cmd = std::make_shared<MoveAckTC>(getId(), getPosition(), NOMOVE, 0);
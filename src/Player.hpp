@@ -37,6 +37,7 @@
 #include "dialog/MerchantDialog.hpp"
 #include "dialog/SelectionDialog.hpp"
 #include "script/LuaScript.hpp"
+#include "db/Connection.hpp"
 
 
 struct WeatherStruct;
@@ -153,6 +154,9 @@ public:
 
     virtual unsigned short int getScreenRange() const override;
 
+    // true if the field at pos is part of the map shown by the client
+    bool isFieldInView(const position &pos) const;
+
     //! die Verbindung zum Spieler, -- Achtung ! Die Verbindung wird NICHT im Destruktor gel�cht
     // , da sie auch extern erstellt wird und durch das Einfgen in diverse
     // Vektoren oft Destruktoren fr tempor�e Player aufgerufen werden, die noch
@@ -160,7 +164,8 @@ public:
     std::shared_ptr<NetInterface> Connection;
 
 private:
-    std::set<uint32_t> visibleChars;
+    // characters whose position was sent to the client and which were not removed since
+    std::unordered_set<TYPE_OF_CHARACTER_ID> visibleChars;
     std::unordered_set<TYPE_OF_CHARACTER_ID> knownPlayers;
     std::unordered_map<TYPE_OF_CHARACTER_ID, std::string> namedPlayers;
     typedef std::queue<ClientCommandPointer> CLIENTCOMMANDLIST;
@@ -189,6 +194,20 @@ public:
     // removes a Char from sight
     void sendCharRemove(TYPE_OF_CHARACTER_ID id, const ServerCommandPointer &removechar);
 
+    const std::unordered_set<TYPE_OF_CHARACTER_ID> &getVisibleChars() const {
+        return visibleChars;
+    }
+
+    // marks a char as visible, returns true if the client did not know it before
+    bool learnChar(TYPE_OF_CHARACTER_ID id) {
+        return id != getId() && visibleChars.insert(id).second;
+    }
+
+    // marks a char as no longer visible, returns true if the client knew it
+    bool forgetChar(TYPE_OF_CHARACTER_ID id) {
+        return visibleChars.erase(id) > 0;
+    }
+
 
     /**
     *a long time needed action for the player
@@ -276,11 +295,11 @@ public:
     */
     virtual void sendCharDescription(TYPE_OF_CHARACTER_ID id,const std::string &desc) override;
 
-    //! normal constructor
-    Player(std::shared_ptr<NetInterface> newConnection);
+    //! normal constructor, loads the player using the given database connection
+    Player(std::shared_ptr<NetInterface> newConnection, const Database::PConnection &dbConnection);
 
     //! check if username/password is ok
-    void check_logindata();
+    void check_logindata(const Database::PConnection &connection);
 
     //Checks if a Player has a special GM right
     bool hasGMRight(gm_rights right) const;
@@ -290,12 +309,12 @@ public:
 
     //! load data from db
     // \param no_attributes don't load contents of table "player"
-    bool load() noexcept;
+    bool load(const Database::PConnection &connection) noexcept;
 
     void login();
 
     //Loads the GM Flag of the character
-    bool loadGMFlags() noexcept;
+    bool loadGMFlags(const Database::PConnection &connection) noexcept;
 
     /**
     * sends one area relative to the current z coordinate to the player
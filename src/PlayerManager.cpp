@@ -16,7 +16,10 @@
 //  You should have received a copy of the GNU Affero General Public License
 //  along with illarionserver.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+#include <iterator>
 #include <memory>
+#include <vector>
 
 #include "PlayerManager.hpp"
 
@@ -27,6 +30,9 @@
 #include "MonitoringClients.hpp"
 #include "LongTimeAction.hpp"
 #include "Config.hpp"
+#include "Statistics.hpp"
+
+#include "db/ConnectionManager.hpp"
 
 #include "script/LuaLogoutScript.hpp"
 
@@ -36,7 +42,12 @@
 
 std::unique_ptr<PlayerManager> PlayerManager::instance = nullptr;
 std::mutex PlayerManager::mut;
-std::mutex PlayerManager::reloadmutex;
+std::shared_timed_mutex PlayerManager::reloadmutex;
+
+namespace {
+// how long the pipeline threads block on an empty queue before checking if they should stop
+const auto queueWaitTime = std::chrono::milliseconds(500);
+}
 
 PlayerManager &PlayerManager::get() {
     if (!instance) {
@@ -50,7 +61,19 @@ void PlayerManager::activate() {
     running = true;
 
     login_thread = std::make_unique<std::thread>(loginLoop, this);
+
+    const int loadWorkers = std::max<int>(1, Config::instance().login_workers);
+
+    for (int i = 0; i < loadWorkers; ++i) {
+        load_threads.emplace_back(loadLoop, this);
+    }
+
     save_thread = std::make_unique<std::thread>(playerSaveLoop, this);
+
+    auto &statistics = Statistic::Statistics::getInstance();
+    statistics.registerGauge("load_queue", [this] { return static_cast<double>(validatedConnections.size()); });
+    statistics.registerGauge("logged_in_queue", [this] { return static_cast<double>(loggedInPlayers.size()); });
+    statistics.registerGauge("logout_queue", [this] { return static_cast<double>(loggedOutPlayers.size()); });
 }
 
 void PlayerManager::stop() {
@@ -59,6 +82,12 @@ void PlayerManager::stop() {
     Logger::info(LogFacility::Other) << "Waiting for login thread to terminate ..." << Log::end;
     login_thread->join();
 
+    Logger::info(LogFacility::Other) << "Waiting for player load threads to terminate ..." << Log::end;
+
+    for (auto &load_thread : load_threads) {
+        load_thread.join();
+    }
+
     Logger::info(LogFacility::Other) << "Waiting for player save thread to terminate ..." << Log::end;
     save_thread->join();
 
@@ -67,14 +96,28 @@ void PlayerManager::stop() {
 
 bool PlayerManager::findPlayer(const std::string &name) const {
     std::lock_guard<std::mutex> lock(mut);
+    return unsavedPlayers.find(name) != unsavedPlayers.end();
+}
 
-    for (auto const &player : loggedOutPlayers) {
-        if (player->getName() == name) {
-            return true;
-        }
+void PlayerManager::logoutPlayer(Player *player) {
+    player->effects.prepareSave();
+
+    {
+        std::lock_guard<std::mutex> lock(mut);
+        unsavedPlayers.insert(player->getName());
     }
 
-    return false;
+    loggedOutPlayers.push(player);
+}
+
+bool PlayerManager::reserveLogin(const std::string &name) {
+    std::lock_guard<std::mutex> lock(mut);
+    return pendingLogins.insert(name).second;
+}
+
+void PlayerManager::loginFinished(const std::string &name) {
+    std::lock_guard<std::mutex> lock(mut);
+    pendingLogins.erase(name);
 }
 
 void PlayerManager::setLoginLogout(bool val) {
@@ -88,74 +131,103 @@ void PlayerManager::setLoginLogout(bool val) {
 void PlayerManager::loginLoop(PlayerManager *pmanager) {
     try {
         auto &newplayers = pmanager->incon->getNewPlayers();
-        timespec waittime;
-        waittime.tv_sec = 0;
-        waittime.tv_nsec = 100000000;
         pmanager->threadOk = true;
+        std::shared_ptr<NetInterface> Connection;
 
         while (pmanager->running) {
-            //loop must be steered by counter so we parse every connection only one time bevor we getting to the other loop
-            int curconn = newplayers.size();
-	    unsigned short acceptVersion = Config::instance().clientversion;
-
-            for (int i = 0; i < curconn; ++i) {
-                auto Connection = newplayers.pop_front();
-
-                if (Connection) {
-                    try {
-                        if (!Connection->online) {
-                            throw Player::LogoutException(UNSTABLECONNECTION);
-                        }
-
-			auto loginData = Connection->getLoginData();
-			if (loginData != nullptr) {
-			    unsigned short int clientversion = loginData->getClientVersion();
-			    if (clientversion == 200) {
-				    // TODO handle login for BBIWI Clients...
-			    } else if (clientversion != acceptVersion) {
-				    Logger::error(LogFacility::Player) << loginData->getLoginName() << " tried to login with an old client (version " << clientversion << ") but version " << acceptVersion << " is required" << Log::end;
-				    throw Player::LogoutException(OLDCLIENT);
-			    }
-
-			    // TODO is this check really necessary?
-			    if (loginData->getLoginName() == "" || loginData->getPassword() == "")
-				    throw Player::LogoutException(WRONGPWD);
-
-			    // player already online?
-			    if (World::get()->Players.find(loginData->getLoginName()) || PlayerManager::get().findPlayer(loginData->getLoginName())) {
-				    Logger::alert(LogFacility::Player) << loginData->getLoginName() << " tried to login twice from ip: " << Connection->getIPAdress() << Log::end;
-				    throw Player::LogoutException(DOUBLEPLAYER);
-			    }
-
-                            Player *newPlayer = nullptr;
-                            {
-                                std::lock_guard<std::mutex> lock(reloadmutex);
-                                newPlayer = new Player(Connection);
-                            }
-                            
-			    pmanager->loggedInPlayers.push_back(newPlayer);
-			    World::get()->scheduler.signalNewPlayerAction();
-
-                            Connection.reset();
-                        } else {
-                            if (Connection->nextInactive()) {
-                                throw Player::LogoutException(UNSTABLECONNECTION);
-                            }
-
-                            newplayers.push_back(Connection);
-                            Connection.reset();
-                        }
-                    } catch (Player::LogoutException &e) {
-                        ServerCommandPointer cmd = std::make_shared<LogOutTC>(e.getReason());
-                        Connection->shutdownSend(cmd);
-                    }
-                } else {
-                    Connection.reset();
+            if (!newplayers.pop(Connection, queueWaitTime)) {
+                continue;
+            }
+
+            unsigned short acceptVersion = Config::instance().clientversion;
+
+            try {
+                if (!Connection->online) {
+                    throw Player::LogoutException(UNSTABLECONNECTION);
+                }
+
+                auto loginData = Connection->getLoginData();
+                unsigned short int clientversion = loginData->getClientVersion();
+
+                if (clientversion == 200) {
+                    // TODO handle login for BBIWI Clients...
+                } else if (clientversion != acceptVersion) {
+                    Logger::error(LogFacility::Player) << loginData->getLoginName() << " tried to login with an old client (version " << clientversion << ") but version " << acceptVersion << " is required" << Log::end;
+                    throw Player::LogoutException(OLDCLIENT);
+                }
+
+                // TODO is this check really necessary?
+                if (loginData->getLoginName() == "" || loginData->getPassword() == "") {
+                    throw Player::LogoutException(WRONGPWD);
+                }
+
+                // player already online or currently logging in?
+                if (World::get()->Players.find(loginData->getLoginName()) || pmanager->findPlayer(loginData->getLoginName())
+                    || !pmanager->reserveLogin(loginData->getLoginName())) {
+                    Logger::alert(LogFacility::Player) << loginData->getLoginName() << " tried to login twice from ip: " << Connection->getIPAdress() << Log::end;
+                    throw Player::LogoutException(DOUBLEPLAYER);
                 }
 
-            } // get new players
+                pmanager->validatedConnections.push(Connection);
+            } catch (Player::LogoutException &e) {
+                ServerCommandPointer cmd = std::make_shared<LogOutTC>(e.getReason());
+                Connection->shutdownSend(cmd);
+            }
+
+            Connection.reset();
+        }
+    } catch (std::exception &e) {
+
+    } catch (...) {
+        throw;
+    }
+}
+
+void PlayerManager::loadLoop(PlayerManager *pmanager) {
+    try {
+        std::shared_ptr<NetInterface> Connection;
+        Database::PConnection dbConnection;
+
+        while (pmanager->running) {
+            if (!pmanager->validatedConnections.pop(Connection, queueWaitTime)) {
+                continue;
+            }
+
+            const auto name = Connection->getLoginData()->getLoginName();
+
+            try {
+                if (!dbConnection) {
+                    dbConnection = Database::ConnectionManager::getInstance().getConnection();
+                }
+
+                Player *newPlayer = nullptr;
+                {
+                    std::shared_lock<std::shared_timed_mutex> lock(reloadmutex);
+                    newPlayer = new Player(Connection, dbConnection);
+                }
+
+                // the main thread releases the name once the player is in the world
+                pmanager->loggedInPlayers.push(newPlayer);
+                World::get()->scheduler.signalNewPlayerAction();
+            } catch (Player::LogoutException &e) {
+                ServerCommandPointer cmd = std::make_shared<LogOutTC>(e.getReason());
+                Connection->shutdownSend(cmd);
+                pmanager->loginFinished(name);
+
+                // wrong passwords and the like keep the connection, a query which failed
+                // and was turned into a logout by Player leaves its transaction open
+                if (dbConnection && dbConnection->transactionActive()) {
+                    dbConnection.reset();
+                }
+            } catch (std::exception &e) {
+                Logger::error(LogFacility::Player) << "Loading " << name << " failed: " << e.what() << Log::end;
+                ServerCommandPointer cmd = std::make_shared<LogOutTC>(UNSTABLECONNECTION);
+                Connection->shutdownSend(cmd);
+                pmanager->loginFinished(name);
+                dbConnection.reset();
+            }
 
-            nanosleep(&waittime, nullptr);
+            Connection.reset();
         }
     } catch (std::exception &e) {
 
@@ -167,43 +239,49 @@ void PlayerManager::loginLoop(PlayerManager *pmanager) {
 void PlayerManager::playerSaveLoop(PlayerManager *pmanager) {
     try {
         World *world = World::get();
-        timespec waittime;
-        waittime.tv_sec = 0;
-        waittime.tv_nsec = 100000000;
         pmanager->threadOk = true;
+        std::vector<Player *> batch;
+        batch.reserve(LOGOUT_QUEUE_SIZE);
         Player *tmpPl = nullptr;
 
         while (pmanager->running || !pmanager->loggedOutPlayers.empty()) {
-            if (!pmanager->loggedOutPlayers.empty()) {
-                while (!pmanager->loggedOutPlayers.empty()) {
-                    tmpPl = pmanager->loggedOutPlayers.front();
-
-                    if (!tmpPl->isMonitoringClient()) {
-                        {
-                            std::lock_guard<std::mutex> lock(reloadmutex);
-                            tmpPl->save();
-                        }
-                        tmpPl->Connection->closeConnection();
-                        ServerCommandPointer cmd = std::make_shared<BBLogOutTC>(tmpPl->getId());
-                        world->monitoringClientList->sendCommand(cmd);
-                        delete tmpPl;
-                        tmpPl = nullptr;
-                    } else {
-                        tmpPl->Connection->closeConnection();
-                        delete tmpPl;
-                        tmpPl = nullptr;
-                    }
+            if (!pmanager->loggedOutPlayers.pop(tmpPl, queueWaitTime)) {
+                continue;
+            }
 
-                    std::lock_guard<std::mutex> lock(mut);
-                    pmanager->loggedOutPlayers.pop_front();
+            batch.push_back(tmpPl);
+            pmanager->loggedOutPlayers.drain(std::back_inserter(batch), LOGOUT_QUEUE_SIZE);
+
+            for (auto player : batch) {
+                const auto name = player->getName();
+
+                if (!player->isMonitoringClient()) {
+                    {
+                        std::shared_lock<std::shared_timed_mutex> lock(reloadmutex);
+                        player->save();
+                    }
+                    player->Connection->closeConnection();
+                    ServerCommandPointer cmd = std::make_shared<BBLogOutTC>(player->getId());
+                    world->monitoringClientList->sendCommand(cmd);
+                } else {
+                    player->Connection->closeConnection();
                 }
 
-                Logger::debug(LogFacility::World) << "update player list [begin]" << Log::end;
-                world->updatePlayerList();
-                Logger::debug(LogFacility::World) << "update player list [end]" << Log::end;
+                delete player;
+
+                std::lock_guard<std::mutex> lock(mut);
+                auto it = pmanager->unsavedPlayers.find(name);
+
+                if (it != pmanager->unsavedPlayers.end()) {
+                    pmanager->unsavedPlayers.erase(it);
+                }
             }
 
-            nanosleep(&waittime, nullptr);
+            batch.clear();
+
+            Logger::debug(LogFacility::World) << "update player list [begin]" << Log::end;
+            world->updatePlayerList();
+            Logger::debug(LogFacility::World) << "update player list [end]" << Log::end;
         }
 
     } catch (std::exception &e) {
@@ -21,11 +21,16 @@
 #define _PLAYERMANAGER_HPP_
 
 #include <memory>
+#include <string>
 #include <thread>
 #include <mutex>
+#include <shared_mutex>
+#include <vector>
+#include <unordered_set>
 
 #include "InitialConnection.hpp"
-#include "thread_safe_vector.hpp"
+#include "bounded_queue.hpp"
+#include "tuningConstants.hpp"
 
 
 class Player;
@@ -41,16 +46,26 @@ public:
         return threadOk;
     }
 
+    // true if the player is logged out but not yet saved
     bool findPlayer(const std::string &name) const;
 
+    /**
+    * called by the main thread after a loaded player has been put into the
+    * world, so that the name is free for further login attempts again
+    */
+    void loginFinished(const std::string &name);
+
     void setLoginLogout(bool val);
 
-    typedef thread_safe_vector<Player *> TPLAYERVECTOR;
+    typedef bounded_queue<Player *> TPLAYERQUEUE;
 
-    TPLAYERVECTOR &getLogOutPlayers() {
-        return loggedOutPlayers;
-    }
-    TPLAYERVECTOR &getLogInPlayers() {
+    /**
+    * hands a player which is not on the map anymore over to the save thread
+    * which stores and deletes it, blocks while the save thread is too far behind
+    */
+    void logoutPlayer(Player *player);
+
+    TPLAYERQUEUE &getLogInPlayers() {
         return loggedInPlayers;
     }
 
@@ -59,15 +74,33 @@ private:
     static std::unique_ptr<PlayerManager> instance;
 
     /**
-    * loop which is threaded to get new connections
-    * create players, or storing data and deleting old connections
+    * loop which is threaded to validate the login data of new connections
+    * and pass them on to the load stage
     */
     static void loginLoop(PlayerManager *pmanager);
+
+    /**
+    * loop which is threaded to load validated players from the database
+    * and pass them on to the main thread for world insertion,
+    * runs in login_workers threads with one database connection each
+    */
+    static void loadLoop(PlayerManager *pmanager);
+
+    /**
+    * loop which is threaded to store data of logged out players
+    * and delete their connections
+    */
     static void playerSaveLoop(PlayerManager *pmanager);
+
+    bool reserveLogin(const std::string &name);
+
     static std::mutex mut;
 
-    //Mutex der gesetzt wird beim reloaden. (Als multi read single write lock)
-    static std::mutex reloadmutex;
+    /**
+    * held exclusively while tables are reloaded,
+    * loading and saving players only need shared access
+    */
+    static std::shared_timed_mutex reloadmutex;
 
     /**
     * true if the thread is running
@@ -80,20 +113,29 @@ private:
     volatile bool threadOk = false;
 
     /**
-    * logged out players which connection wherent shutted down
+    * player which are not on the main map anymore
     */
-    //CInitialConnection::TVECTORPLAYER shutdownConnections;
+    TPLAYERQUEUE loggedOutPlayers{LOGOUT_QUEUE_SIZE};
 
     /**
-    * player which are not on the main map anymore
+    * names of players in loggedOutPlayers or being saved, guarded by mut
     */
-    TPLAYERVECTOR loggedOutPlayers;
-
+    std::unordered_multiset<std::string> unsavedPlayers;
 
     /**
     * players which are logged in and correctly loaded
     */
-    TPLAYERVECTOR loggedInPlayers;
+    TPLAYERQUEUE loggedInPlayers{LOGIN_QUEUE_SIZE};
+
+    /**
+    * connections with valid login data waiting to be loaded
+    */
+    InitialConnection::NewPlayerQueue validatedConnections{LOGIN_QUEUE_SIZE};
+
+    /**
+    * names of players currently passing the login pipeline, guarded by mut
+    */
+    std::unordered_set<std::string> pendingLogins;
 
     /**
     * initial connection to get the new connections
@@ -101,6 +143,7 @@ private:
     std::shared_ptr<InitialConnection> incon = InitialConnection::create();
 
     std::unique_ptr<std::thread> login_thread = nullptr;
+    std::vector<std::thread> load_threads;
     std::unique_ptr<std::thread> save_thread = nullptr;
 };
 
@@ -28,14 +28,17 @@
 #include "Statistics.hpp"
 
 void Player::workoutCommands() {
+    using namespace Statistic;
+    static const auto incomingDone = Statistics::getInstance().registerMetric("command_incoming_done");
+    static const auto incomingDoneAP = Statistics::getInstance().registerMetric("command_incoming_done_ap");
+
     std::unique_lock<std::mutex> lock(commandMutex);
     while (!immediateCommands.empty()) {
 	    ClientCommandPointer cmd = immediateCommands.front();
 	    immediateCommands.pop();
 	    lock.unlock();
 	    cmd->performAction(this);
-	    using namespace Statistic;
-	    Statistics::getInstance().logTime("command_incoming_done", std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - cmd->getIncomingTime()).count());
+	    Statistics::getInstance().record(incomingDone, std::chrono::steady_clock::now() - cmd->getIncomingTime());
 	    lock.lock();
     }
 
@@ -44,8 +47,7 @@ void Player::workoutCommands() {
 	    queuedCommands.pop();
 	    lock.unlock();
 	    cmd->performAction(this);
-	    using namespace Statistic;
-	    Statistics::getInstance().logTime("command_incoming_done_ap", std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - cmd->getIncomingTime()).count());
+	    Statistics::getInstance().record(incomingDoneAP, std::chrono::steady_clock::now() - cmd->getIncomingTime());
 	    lock.lock();
     }
 }
@@ -18,20 +18,109 @@
 
 #include "Random.hpp"
 
-std::mt19937 Random::rng;
+#include <atomic>
+#include <random>
+#include <utility>
+
+namespace {
+
+// splitmix64 finaliser, spreads similar inputs over the whole range
+uint64_t mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+const uint64_t golden = 0x9e3779b97f4a7c15ULL;
+
+uint64_t initialSeed() {
+    std::random_device device;
+    return uint64_t(device()) << 32 | device();
+}
+
+std::atomic<uint64_t> baseSeed{initialSeed()};
+std::atomic<uint32_t> seedGeneration{1};
+std::atomic<uint64_t> nextStream{0};
+
+struct ThreadEngine {
+    Random::Engine engine;
+    uint32_t generation = 0;
+};
+
+thread_local ThreadEngine threadEngine;
+
+int uniformInt(Random::Engine &engine, int min, int max) {
+    if (max < min) {
+        std::swap(min, max);
+    }
+
+    // Lemire's multiply and shift with rejection, no division in the common case
+    const uint64_t range = uint64_t(int64_t(max) - int64_t(min)) + 1;
+    uint64_t product = (engine() >> 32) * range;
+
+    if (uint32_t(product) < range) {
+        const uint32_t threshold = ((uint64_t(1) << 32) - range) % range;
+
+        while (uint32_t(product) < threshold) {
+            product = (engine() >> 32) * range;
+        }
+    }
+
+    return int(int64_t(min) + int64_t(product >> 32));
+}
+
+}
+
+Random::Engine::Engine(uint64_t seed) {
+    for (auto &word : state) {
+        seed += golden;
+        word = mix(seed);
+    }
+}
+
+Random::Engine &Random::engine() {
+    const auto generation = seedGeneration.load(std::memory_order_acquire);
+
+    if (threadEngine.generation != generation) {
+        const auto stream = nextStream.fetch_add(1);
+        threadEngine.engine = Engine(baseSeed.load() ^ mix(stream + golden));
+        threadEngine.generation = generation;
+    }
+
+    return threadEngine.engine;
+}
+
+void Random::seed(uint64_t seed) {
+    baseSeed.store(seed);
+    nextStream.store(0);
+    seedGeneration.fetch_add(1, std::memory_order_release);
+}
 
 double Random::uniform() {
-    std::uniform_real_distribution<double> uniform(0, 1);
-    return uniform(rng);
+    return (engine()() >> 11) * (1.0 / 9007199254740992.0);
 }
 
 int Random::uniform(int min, int max) {
-    std::uniform_int_distribution<int> uniform(min, max);
-    return uniform(rng);
+    return uniformInt(engine(), min, max);
 }
 
 double Random::normal(double mean, double sd) {
     std::normal_distribution<double> norm(mean, sd);
-    return norm(rng);
+    return norm(engine());
 }
 
+void Random::fill(uint64_t *words, size_t count) {
+    auto &rng = engine();
+
+    for (size_t i = 0; i < count; ++i) {
+        words[i] = rng();
+    }
+}
+
+void Random::uniform(int min, int max, int *values, size_t count) {
+    auto &rng = engine();
+
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = uniformInt(rng, min, max);
+    }
+}
@@ -20,17 +20,74 @@
 #ifndef _RANDOM_HPP_
 #define _RANDOM_HPP_
 
-#include <random>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 
+/**
+* random numbers for the whole server
+*
+* every thread draws from its own generator, so Random can be used from
+* worker threads without locking; all generators are derived from one seed,
+* which tests can set to get reproducible results
+*/
 class Random {
-private:
-    static std::mt19937 rng;
-    Random() {};
 public:
+    /**
+    * xoshiro256**, usable with the distributions of <random>
+    */
+    class Engine {
+    public:
+        typedef uint64_t result_type;
+
+        explicit Engine(uint64_t seed = 0);
+
+        static constexpr result_type min() {
+            return 0;
+        }
+
+        static constexpr result_type max() {
+            return std::numeric_limits<result_type>::max();
+        }
+
+        result_type operator()() {
+            const uint64_t result = rotl(state[1] * 5, 7) * 9;
+            const uint64_t t = state[1] << 17;
+            state[2] ^= state[0];
+            state[3] ^= state[1];
+            state[1] ^= state[2];
+            state[0] ^= state[3];
+            state[2] ^= t;
+            state[3] = rotl(state[3], 45);
+            return result;
+        }
+
+    private:
+        static uint64_t rotl(uint64_t x, int k) {
+            return (x << k) | (x >> (64 - k));
+        }
+
+        uint64_t state[4];
+    };
+
+    // in [0, 1)
     static double uniform();
+    // in [min, max]
     static int uniform(int min, int max);
     static double normal(double mean, double sd);
+
+    // bulk draws for callers that need many numbers at once
+    static void fill(uint64_t *words, size_t count);
+    static void uniform(int min, int max, int *values, size_t count);
+
+    // reseeds the generators of all threads, afterwards the draws of a single thread are reproducible
+    static void seed(uint64_t seed);
+
+    // generator of the calling thread
+    static Engine &engine();
+
+private:
+    Random() {};
 };
 
 #endif
-
@@ -20,59 +20,205 @@
 #ifndef _SCHEDULER_HPP_
 #define _SCHEDULER_HPP_
 
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <string>
 #include <chrono>
-#include <queue>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 #include <condition_variable>
 
-template<typename clock_type>
-class Task {
+#include "Statistics.hpp"
+
+/**
+* identifies a task added to a ClockBasedScheduler, used to cancel it
+*
+* a handle stays safe to use after its task finished, cancelling it is then a no-op
+*/
+class TaskHandle {
 	public:
-		Task(std::function<void()> task, typename clock_type::time_point start_point, std::chrono::nanoseconds interval, const std::string& name);
+		TaskHandle() = default;
 
-		inline bool operator<(const Task& other) const {
-			return other._next < _next;
+		inline bool valid() const {
+			return _generation != 0;
 		}
 
-		bool run();
+	private:
+		template<typename clock_type> friend class ClockBasedScheduler;
 
-		inline std::string getName() const {
-			return _name;
-		}
+		TaskHandle(uint32_t index, uint32_t generation) : _index(index), _generation(generation) {}
 
-		inline typename clock_type::time_point getNextTime() const {
-			return _next;
-		}
+		uint32_t _index = 0;
+		uint32_t _generation = 0;
+};
 
-	private:
-		std::function<void()> _task;
+/**
+* order in which tasks due at the same time are run
+*/
+enum class TaskPriority : uint8_t {
+	high,
+	normal,
+	low
+};
 
-		typename clock_type::time_point _next;
-		std::chrono::nanoseconds _interval;
-		std::string _name;
+/**
+* run time accounting of all tasks with the same name
+*/
+struct TaskStatistics {
+	std::string name;
+	std::chrono::nanoseconds budget;
+	uint64_t runs;
+	uint64_t overruns;
+	std::chrono::nanoseconds total;
+	std::chrono::nanoseconds longest;
 };
 
+/**
+* runs one-shot and recurring tasks at their due time
+*
+* tasks are kept in a hierarchical timing wheel with a resolution of one millisecond:
+* four levels of 64 slots each cover about 4.6 hours, tasks further in the future wait
+* in an overflow list. Every slot is an intrusive list of pooled task nodes, so adding
+* and cancelling a task is O(1) and running it does not copy its function or name.
+*
+* every task name can be given a time budget per run and a priority, due tasks run by
+* priority and runs longer than the budget are counted as overruns. Sliced tasks split
+* their work into resumable units: they work until the deadline given to them and are
+* resumed later until they report that their cycle is finished.
+*/
 template<typename clock_type>
 class ClockBasedScheduler {
 	public:
-		void addOneshotTask(std::function<void()> task, const std::chrono::nanoseconds delay, const std::string& taskname);
-		void addRecurringTask(std::function<void()> task, const std::chrono::nanoseconds interval, const std::string& taskname, bool start_immediately = false);
-		void addRecurringTask(std::function<void()> task, const std::chrono::nanoseconds interval, typename clock_type::time_point first_time, const std::string& taskname);
+		ClockBasedScheduler();
+		ClockBasedScheduler(const ClockBasedScheduler&) = delete;
+		ClockBasedScheduler& operator=(const ClockBasedScheduler&) = delete;
+
+		TaskHandle addOneshotTask(std::function<void()> task, const std::chrono::nanoseconds delay, const std::string& taskname);
+		TaskHandle addRecurringTask(std::function<void()> task, const std::chrono::nanoseconds interval, const std::string& taskname, bool start_immediately = false);
+		TaskHandle addRecurringTask(std::function<void()> task, const std::chrono::nanoseconds interval, typename clock_type::time_point first_time, const std::string& taskname);
+
+		// task returns true once its cycle is finished, the next cycle starts interval after the last one
+		// unfinished cycles are resumed after resume_delay, every call has to make some progress
+		typedef std::function<bool(typename clock_type::time_point deadline)> sliced_task_t;
+		TaskHandle addSlicedTask(sliced_task_t task, const std::chrono::nanoseconds interval, const std::chrono::nanoseconds resume_delay, const std::string& taskname);
+
+		// a budget of zero means unlimited, sliced tasks are then run until their cycle is finished
+		void setTaskBudget(const std::string& taskname, std::chrono::nanoseconds budget, TaskPriority priority = TaskPriority::normal);
+		std::vector<TaskStatistics> getTaskStatistics(bool reset = false);
+
+		// returns true if the task was still scheduled, a running task will not be rescheduled
+		bool cancelTask(TaskHandle handle);
+
 		void signalNewPlayerAction();
 
 		void run_once(std::chrono::nanoseconds max_timeout);
 
+		// number of scheduled and running tasks
+		size_t size();
+
 	private:
+		typedef int64_t tick_t;
+		typedef std::chrono::milliseconds tick_duration;
+
+		static constexpr int SLOT_BITS = 6;
+		static constexpr tick_t SLOTS = tick_t(1) << SLOT_BITS;
+		static constexpr int LEVELS = 4;
+		static constexpr uint8_t OVERFLOW_LEVEL = LEVELS;
+		static constexpr uint8_t DUE_LEVEL = LEVELS + 1;
+		static constexpr int PRIORITIES = 3;
+
+		enum TaskState : uint8_t {
+			TASK_FREE,
+			TASK_WAITING,
+			TASK_RUNNING,
+			TASK_CANCELLED
+		};
+
+		struct TaskNode {
+			std::function<void()> task;
+			sliced_task_t slice;
+			typename clock_type::time_point next;
+			std::chrono::nanoseconds interval;
+			std::chrono::nanoseconds resume_delay;
+			tick_t expiry = 0;
+
+			TaskNode *prev = nullptr;
+			TaskNode *succ = nullptr;
+
+			uint32_t index = 0;
+			uint32_t generation = 0;
+			uint16_t name = 0;
+			TaskState state = TASK_FREE;
+
+			// wheel level and slot of a waiting task, OVERFLOW_LEVEL or DUE_LEVEL and priority otherwise
+			uint8_t level = 0;
+			uint8_t slot = 0;
+		};
+
+		struct TaskList {
+			TaskNode *head = nullptr;
+			TaskNode *tail = nullptr;
+
+			inline bool empty() const {
+				return head == nullptr;
+			}
+
+			void push_back(TaskNode *node);
+			void unlink(TaskNode *node);
+			TaskNode *pop_front();
+		};
+
+		struct TaskInfo {
+			std::string name;
+			Statistic::Metric metric;
+			std::chrono::nanoseconds budget = std::chrono::nanoseconds::zero();
+			TaskPriority priority = TaskPriority::normal;
+			uint64_t runs = 0;
+			uint64_t overruns = 0;
+			std::chrono::nanoseconds total = std::chrono::nanoseconds::zero();
+			std::chrono::nanoseconds longest = std::chrono::nanoseconds::zero();
+		};
+
+		TaskNode *addTask(typename clock_type::time_point start_time, std::chrono::nanoseconds interval, const std::string& taskname);
+
 		std::chrono::nanoseconds getNextTaskTime();
 		void execute_tasks();
 
+		// all of the following require _container_mutex to be held
+		tick_t toTick(typename clock_type::time_point time) const;
+		uint16_t internName(const std::string& name);
+		TaskNode *popDue();
+		TaskNode *allocateNode();
+		void freeNode(TaskNode *node);
+		void insert(TaskNode *node);
+		void remove(TaskNode *node);
+		TaskList &listOf(const TaskNode *node);
+		void advance(tick_t target);
+		void cascade();
+		tick_t nextPendingTick() const;
+
 		std::mutex _new_action_signal_mutex;
 		std::condition_variable _new_action_available_cond;
 
-		typedef std::priority_queue<Task<clock_type>> task_container_t;
-		task_container_t _tasks;
+		typename clock_type::time_point _origin;
+		tick_t _current = 0;
+
+		std::array<std::array<TaskList, SLOTS>, LEVELS> _wheel;
+		std::array<uint64_t, LEVELS> _occupied;
+		TaskList _overflow;
+		std::array<TaskList, PRIORITIES> _due;
+
+		std::deque<TaskNode> _nodes;
+		TaskNode *_free_nodes = nullptr;
+		size_t _task_count = 0;
+
+		std::unordered_map<std::string, uint16_t> _name_ids;
+		std::deque<TaskInfo> _task_infos;
+
 		std::mutex _container_mutex;
 };
 
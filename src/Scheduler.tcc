@@ -16,46 +16,172 @@
 //  You should have received a copy of the GNU Affero General Public License
 //  along with illarionserver.  If not, see <http://www.gnu.org/licenses/>.
 
-#include "Statistics.hpp"
+#include <algorithm>
+#include <limits>
 
 template<typename clock_type>
-Task<clock_type>::Task(std::function<void()> task, typename clock_type::time_point start_point, std::chrono::nanoseconds interval, const std::string& name) : _task(task), _next(start_point), _interval(interval), _name(name) { }
+constexpr int ClockBasedScheduler<clock_type>::SLOT_BITS;
 
 template<typename clock_type>
-bool Task<clock_type>::run() {
-    using Statistic::Statistics;
-    Statistics::getInstance().startTimer(_name);
-	_task();
-    Statistics::getInstance().stopTimer(_name);
+constexpr typename ClockBasedScheduler<clock_type>::tick_t ClockBasedScheduler<clock_type>::SLOTS;
 
-	if (_interval > std::chrono::nanoseconds::zero()) {
-		_next += std::chrono::duration_cast<typename clock_type::duration>(_interval);
-		return true;
-	}
+template<typename clock_type>
+constexpr int ClockBasedScheduler<clock_type>::LEVELS;
 
-	return false;
+template<typename clock_type>
+constexpr uint8_t ClockBasedScheduler<clock_type>::OVERFLOW_LEVEL;
+
+template<typename clock_type>
+constexpr uint8_t ClockBasedScheduler<clock_type>::DUE_LEVEL;
+
+template<typename clock_type>
+constexpr int ClockBasedScheduler<clock_type>::PRIORITIES;
+
+template<typename clock_type>
+void ClockBasedScheduler<clock_type>::TaskList::push_back(TaskNode *node) {
+	node->prev = tail;
+	node->succ = nullptr;
+
+	if (tail)
+		tail->succ = node;
+	else
+		head = node;
+
+	tail = node;
 }
 
 template<typename clock_type>
-void ClockBasedScheduler<clock_type>::addOneshotTask(std::function<void()> task, const std::chrono::nanoseconds delay, const std::string& taskname) {
+void ClockBasedScheduler<clock_type>::TaskList::unlink(TaskNode *node) {
+	if (node->prev)
+		node->prev->succ = node->succ;
+	else
+		head = node->succ;
+
+	if (node->succ)
+		node->succ->prev = node->prev;
+	else
+		tail = node->prev;
+
+	node->prev = nullptr;
+	node->succ = nullptr;
+}
+
+template<typename clock_type>
+typename ClockBasedScheduler<clock_type>::TaskNode *ClockBasedScheduler<clock_type>::TaskList::pop_front() {
+	TaskNode *node = head;
+
+	if (node)
+		unlink(node);
+
+	return node;
+}
+
+template<typename clock_type>
+ClockBasedScheduler<clock_type>::ClockBasedScheduler() : _origin(clock_type::now()) {
+	_occupied.fill(0);
+}
+
+template<typename clock_type>
+TaskHandle ClockBasedScheduler<clock_type>::addOneshotTask(std::function<void()> task, const std::chrono::nanoseconds delay, const std::string& taskname) {
 	std::unique_lock<std::mutex> lock(_container_mutex);
 	typename clock_type::time_point start_time = clock_type::now() + std::chrono::duration_cast<typename clock_type::duration>(delay);
-	_tasks.emplace(task, start_time, std::chrono::nanoseconds::zero(), taskname);
+	TaskNode *node = addTask(start_time, std::chrono::nanoseconds::zero(), taskname);
+	node->task = std::move(task);
+	return TaskHandle(node->index, node->generation);
 }
 
 template<typename clock_type>
-void ClockBasedScheduler<clock_type>::addRecurringTask(std::function<void()> task, const std::chrono::nanoseconds interval, const std::string& taskname, bool start_immediately) {
+TaskHandle ClockBasedScheduler<clock_type>::addRecurringTask(std::function<void()> task, const std::chrono::nanoseconds interval, const std::string& taskname, bool start_immediately) {
 	std::unique_lock<std::mutex> lock(_container_mutex);
 	typename clock_type::time_point start_time = clock_type::now();
 	if (!start_immediately)
 		start_time += std::chrono::duration_cast<typename clock_type::duration>(interval);
-	_tasks.emplace(task, start_time, interval, taskname);
+	TaskNode *node = addTask(start_time, interval, taskname);
+	node->task = std::move(task);
+	return TaskHandle(node->index, node->generation);
+}
+
+template<typename clock_type>
+TaskHandle ClockBasedScheduler<clock_type>::addRecurringTask(std::function<void()> task, const std::chrono::nanoseconds interval, typename clock_type::time_point first_time, const std::string& taskname) {
+	std::unique_lock<std::mutex> lock(_container_mutex);
+	TaskNode *node = addTask(first_time, interval, taskname);
+	node->task = std::move(task);
+	return TaskHandle(node->index, node->generation);
+}
+
+template<typename clock_type>
+TaskHandle ClockBasedScheduler<clock_type>::addSlicedTask(sliced_task_t task, const std::chrono::nanoseconds interval, const std::chrono::nanoseconds resume_delay, const std::string& taskname) {
+	std::unique_lock<std::mutex> lock(_container_mutex);
+	typename clock_type::time_point start_time = clock_type::now() + std::chrono::duration_cast<typename clock_type::duration>(interval);
+	TaskNode *node = addTask(start_time, interval, taskname);
+	node->slice = std::move(task);
+	node->resume_delay = resume_delay;
+	return TaskHandle(node->index, node->generation);
+}
+
+template<typename clock_type>
+typename ClockBasedScheduler<clock_type>::TaskNode *ClockBasedScheduler<clock_type>::addTask(typename clock_type::time_point start_time, std::chrono::nanoseconds interval, const std::string& taskname) {
+	TaskNode *node = allocateNode();
+	node->next = start_time;
+	node->interval = interval;
+	node->resume_delay = std::chrono::nanoseconds::zero();
+	node->expiry = toTick(start_time);
+	node->name = internName(taskname);
+	node->state = TASK_WAITING;
+	insert(node);
+	return node;
 }
 
 template<typename clock_type>
-void ClockBasedScheduler<clock_type>::addRecurringTask(std::function<void()> task, const std::chrono::nanoseconds interval, typename clock_type::time_point first_time, const std::string& taskname) {
+void ClockBasedScheduler<clock_type>::setTaskBudget(const std::string& taskname, std::chrono::nanoseconds budget, TaskPriority priority) {
 	std::unique_lock<std::mutex> lock(_container_mutex);
-	_tasks.emplace(task, first_time, interval, taskname);
+	TaskInfo &info = _task_infos[internName(taskname)];
+	info.budget = budget;
+	info.priority = priority;
+}
+
+template<typename clock_type>
+std::vector<TaskStatistics> ClockBasedScheduler<clock_type>::getTaskStatistics(bool reset) {
+	std::unique_lock<std::mutex> lock(_container_mutex);
+	std::vector<TaskStatistics> statistics;
+	statistics.reserve(_task_infos.size());
+
+	for (auto &info : _task_infos) {
+		statistics.push_back({info.name, info.budget, info.runs, info.overruns, info.total, info.longest});
+
+		if (reset) {
+			info.runs = 0;
+			info.overruns = 0;
+			info.total = std::chrono::nanoseconds::zero();
+			info.longest = std::chrono::nanoseconds::zero();
+		}
+	}
+
+	return statistics;
+}
+
+template<typename clock_type>
+bool ClockBasedScheduler<clock_type>::cancelTask(TaskHandle handle) {
+	std::unique_lock<std::mutex> lock(_container_mutex);
+
+	if (!handle.valid() || handle._index >= _nodes.size())
+		return false;
+
+	TaskNode *node = &_nodes[handle._index];
+
+	if (node->generation != handle._generation)
+		return false;
+
+	if (node->state == TASK_WAITING) {
+		remove(node);
+		freeNode(node);
+		return true;
+	}
+
+	if (node->state == TASK_RUNNING)
+		node->state = TASK_CANCELLED;
+
+	return false;
 }
 
 template<typename clock_type>
@@ -77,13 +203,26 @@ void ClockBasedScheduler<clock_type>::run_once(std::chrono::nanoseconds max_time
 	execute_tasks();
 }
 
+template<typename clock_type>
+size_t ClockBasedScheduler<clock_type>::size() {
+	std::unique_lock<std::mutex> lock(_container_mutex);
+	return _task_count;
+}
+
 template<typename clock_type>
 std::chrono::nanoseconds ClockBasedScheduler<clock_type>::getNextTaskTime() {
 	std::unique_lock<std::mutex> lock(_container_mutex);
-	if (_tasks.empty())
+	for (const auto &due : _due) {
+		if (!due.empty())
+			return std::chrono::nanoseconds::zero();
+	}
+
+	tick_t next_tick = nextPendingTick();
+
+	if (next_tick == std::numeric_limits<tick_t>::max())
 		return std::chrono::nanoseconds::max();
 
-	return _tasks.top().getNextTime() - clock_type::now();
+	return _origin + tick_duration(next_tick) - clock_type::now();
 }
 
 template<typename clock_type>
@@ -91,16 +230,271 @@ void ClockBasedScheduler<clock_type>::execute_tasks() {
 	auto now = clock_type::now();
 
 	std::unique_lock<std::mutex> lock(_container_mutex);
-	while (!_tasks.empty() && now >= _tasks.top().getNextTime()) {
-		auto task = _tasks.top();
-		_tasks.pop();
+	advance(std::chrono::duration_cast<tick_duration>(now - _origin).count());
+
+	while (TaskNode *node = popDue()) {
+		node->state = TASK_RUNNING;
+		// infos are never removed and deque elements do not move
+		TaskInfo &info = _task_infos[node->name];
+		const auto budget = info.budget;
 		lock.unlock();
 
-		bool runResult = task.run();
+		bool finished = true;
+		const auto start = clock_type::now();
+
+		try {
+			if (node->slice) {
+				auto deadline = clock_type::time_point::max();
+
+				if (budget > std::chrono::nanoseconds::zero())
+					deadline = start + std::chrono::duration_cast<typename clock_type::duration>(budget);
+
+				finished = node->slice(deadline);
+			} else {
+				node->task();
+			}
+		} catch (...) {
+			lock.lock();
+			freeNode(node);
+			throw;
+		}
+
+		const auto finish = clock_type::now();
+		const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(finish - start);
+		Statistic::Statistics::getInstance().record(info.metric, elapsed);
 
 		lock.lock();
-		if (runResult)
-			_tasks.push(task);
+		++info.runs;
+		info.total += elapsed;
+		info.longest = std::max(info.longest, elapsed);
+
+		if (budget > std::chrono::nanoseconds::zero() && elapsed > budget)
+			++info.overruns;
+
+		if (node->state == TASK_CANCELLED || (finished && node->interval <= std::chrono::nanoseconds::zero())) {
+			freeNode(node);
+			continue;
+		}
+
+		if (!finished) {
+			node->expiry = toTick(finish + std::chrono::duration_cast<typename clock_type::duration>(node->resume_delay));
+		} else {
+			node->next += std::chrono::duration_cast<typename clock_type::duration>(node->interval);
+
+			// sliced tasks skip cycles they missed instead of catching up
+			if (node->slice && node->next <= finish)
+				node->next = finish + std::chrono::duration_cast<typename clock_type::duration>(node->resume_delay);
+
+			node->expiry = toTick(node->next);
+		}
+
+		// a sliced task gets at most one slice per pass
+		if (node->slice)
+			node->expiry = std::max(node->expiry, _current + 1);
+
+		node->state = TASK_WAITING;
+		// a task which is still due is run again right away, just like before
+		insert(node);
 	}
 }
 
+template<typename clock_type>
+typename ClockBasedScheduler<clock_type>::tick_t ClockBasedScheduler<clock_type>::toTick(typename clock_type::time_point time) const {
+	// round up, a task must never run before its time
+	auto since_origin = time - _origin;
+	auto ticks = std::chrono::duration_cast<tick_duration>(since_origin);
+
+	if (ticks < since_origin)
+		++ticks;
+
+	return ticks.count();
+}
+
+template<typename clock_type>
+uint16_t ClockBasedScheduler<clock_type>::internName(const std::string& name) {
+	auto it = _name_ids.find(name);
+
+	if (it != _name_ids.end())
+		return it->second;
+
+	uint16_t id = static_cast<uint16_t>(_task_infos.size());
+	_task_infos.emplace_back();
+	_task_infos.back().name = name;
+	_task_infos.back().metric = Statistic::Statistics::getInstance().registerMetric(name);
+	_name_ids.emplace(name, id);
+	return id;
+}
+
+template<typename clock_type>
+typename ClockBasedScheduler<clock_type>::TaskNode *ClockBasedScheduler<clock_type>::popDue() {
+	for (auto &due : _due) {
+		if (!due.empty())
+			return due.pop_front();
+	}
+
+	return nullptr;
+}
+
+template<typename clock_type>
+typename ClockBasedScheduler<clock_type>::TaskNode *ClockBasedScheduler<clock_type>::allocateNode() {
+	TaskNode *node = _free_nodes;
+
+	if (node) {
+		_free_nodes = node->succ;
+		node->succ = nullptr;
+	} else {
+		_nodes.emplace_back();
+		node = &_nodes.back();
+		node->index = static_cast<uint32_t>(_nodes.size() - 1);
+	}
+
+	// generation 0 marks an invalid handle
+	if (++node->generation == 0)
+		++node->generation;
+
+	++_task_count;
+	return node;
+}
+
+template<typename clock_type>
+void ClockBasedScheduler<clock_type>::freeNode(TaskNode *node) {
+	node->task = nullptr;
+	node->slice = nullptr;
+	node->state = TASK_FREE;
+	node->prev = nullptr;
+	node->succ = _free_nodes;
+	_free_nodes = node;
+	// invalidate outstanding handles
+	if (++node->generation == 0)
+		++node->generation;
+	--_task_count;
+}
+
+template<typename clock_type>
+typename ClockBasedScheduler<clock_type>::TaskList &ClockBasedScheduler<clock_type>::listOf(const TaskNode *node) {
+	if (node->level == DUE_LEVEL)
+		return _due[node->slot];
+
+	if (node->level == OVERFLOW_LEVEL)
+		return _overflow;
+
+	return _wheel[node->level][node->slot];
+}
+
+template<typename clock_type>
+void ClockBasedScheduler<clock_type>::insert(TaskNode *node) {
+	tick_t delta = node->expiry - _current;
+
+	if (delta <= 0) {
+		node->level = DUE_LEVEL;
+		node->slot = static_cast<uint8_t>(_task_infos[node->name].priority);
+	} else {
+		node->level = OVERFLOW_LEVEL;
+
+		for (int level = 0; level < LEVELS; ++level) {
+			if (delta < (tick_t(1) << (SLOT_BITS * (level + 1)))) {
+				node->level = level;
+				node->slot = (node->expiry >> (SLOT_BITS * level)) & (SLOTS - 1);
+				_occupied[level] |= uint64_t(1) << node->slot;
+				break;
+			}
+		}
+	}
+
+	listOf(node).push_back(node);
+}
+
+template<typename clock_type>
+void ClockBasedScheduler<clock_type>::remove(TaskNode *node) {
+	TaskList &list = listOf(node);
+	list.unlink(node);
+
+	if (node->level < LEVELS && list.empty())
+		_occupied[node->level] &= ~(uint64_t(1) << node->slot);
+}
+
+template<typename clock_type>
+void ClockBasedScheduler<clock_type>::advance(tick_t target) {
+	while (_current < target) {
+		// skip ahead to the next tick with work: a filled level 0 slot or a cascade
+		tick_t next = std::min(target, (_current | (SLOTS - 1)) + 1);
+		int index = _current & (SLOTS - 1);
+
+		if (index < SLOTS - 1) {
+			uint64_t pending = _occupied[0] & (~uint64_t(0) << (index + 1));
+
+			if (pending)
+				next = std::min(next, (_current & ~(SLOTS - 1)) + __builtin_ctzll(pending));
+		}
+
+		_current = next;
+
+		if ((_current & (SLOTS - 1)) == 0)
+			cascade();
+
+		index = _current & (SLOTS - 1);
+		TaskList &slot = _wheel[0][index];
+
+		while (TaskNode *node = slot.pop_front()) {
+			node->level = DUE_LEVEL;
+			node->slot = static_cast<uint8_t>(_task_infos[node->name].priority);
+			_due[node->slot].push_back(node);
+		}
+
+		_occupied[0] &= ~(uint64_t(1) << index);
+	}
+}
+
+template<typename clock_type>
+void ClockBasedScheduler<clock_type>::cascade() {
+	for (int level = 1; level <= LEVELS; ++level) {
+		TaskList tasks;
+
+		if (level < LEVELS) {
+			int index = (_current >> (SLOT_BITS * level)) & (SLOTS - 1);
+			tasks = _wheel[level][index];
+			_wheel[level][index] = TaskList();
+			_occupied[level] &= ~(uint64_t(1) << index);
+
+			while (TaskNode *node = tasks.pop_front())
+				insert(node);
+
+			if (index != 0)
+				break;
+		} else {
+			tasks = _overflow;
+			_overflow = TaskList();
+
+			while (TaskNode *node = tasks.pop_front())
+				insert(node);
+		}
+	}
+}
+
+template<typename clock_type>
+typename ClockBasedScheduler<clock_type>::tick_t ClockBasedScheduler<clock_type>::nextPendingTick() const {
+	tick_t next = std::numeric_limits<tick_t>::max();
+
+	for (int level = 0; level < LEVELS; ++level) {
+		if (_occupied[level] == 0)
+			continue;
+
+		// level 0 slots hold the tasks of exactly that tick, higher level slots
+		// are cascaded when the wheel below them wraps around
+		const int shift = SLOT_BITS * level;
+		const tick_t position = _current >> shift;
+		const int index = position & (SLOTS - 1);
+		const uint64_t rotated = (_occupied[level] >> index) | (index ? _occupied[level] << (SLOTS - index) : 0);
+		tick_t distance = __builtin_ctzll(rotated);
+
+		if (distance == 0)
+			distance = SLOTS;
+
+		next = std::min(next, (position + distance) << shift);
+	}
+
+	if (!_overflow.empty())
+		next = std::min(next, ((_current >> (SLOT_BITS * LEVELS)) + 1) << (SLOT_BITS * LEVELS));
+
+	return next;
+}
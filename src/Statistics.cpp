@@ -20,12 +20,12 @@
 
 #include "Statistics.hpp"
 #include "version.hpp"
+#include "Config.hpp"
 #include "db/ConnectionManager.hpp"
 #include "db/SelectQuery.hpp"
 #include "db/InsertQuery.hpp"
 #include "db/UpdateQuery.hpp"
 #include "db/Query.hpp"
-#include "World.hpp"
 #include "Logger.hpp"
 #include <chrono>
 #include <algorithm>
@@ -34,111 +34,328 @@
 
 namespace Statistic {
 
-Statistics *Statistics::instance = nullptr;
+size_t Histogram::bucketOf(uint64_t value) {
+    if (value < SUB_BUCKETS) {
+        return value;
+    }
 
-Statistics::Statistics() {
-/*
-    loadTypes();
-    auto typesCount = types.size();
-
-    statisticsDB.resize(typesCount);
-    statistics.resize(typesCount);
-    statisticsSave.resize(typesCount);
-    startTimes.resize(typesCount);
-
-    for (size_t i = 0; i < typesCount; ++i) {
-        for (int j = 0; j < DEFAULT_PLAYERS; ++j) {
-            statisticsDB[i].emplace_back();
-            statistics[i].emplace_back();
-            statisticsSave[i].emplace_back();
+    const int exponent = 63 - __builtin_clzll(value);
+
+    if (exponent >= MAX_EXPONENT) {
+        return BUCKETS - 1;
+    }
+
+    const auto subBucket = (value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + subBucket;
+}
+
+uint64_t Histogram::lowerBound(size_t bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+
+    const int exponent = bucket / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    const uint64_t subBucket = bucket % SUB_BUCKETS;
+    return (SUB_BUCKETS + subBucket) << (exponent - SUB_BUCKET_BITS);
+}
+
+uint64_t Histogram::upperBound(size_t bucket) {
+    return lowerBound(bucket + 1);
+}
+
+uint64_t Histogram::percentile(double fraction) const {
+    if (count == 0) {
+        return 0;
+    }
+
+    const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(fraction * count + 0.5));
+    uint64_t seen = 0;
+
+    for (size_t bucket = 0; bucket < buckets.size(); ++bucket) {
+        seen += buckets[bucket];
+
+        if (seen >= rank) {
+            return upperBound(bucket);
         }
     }
 
-    versionId = getVersionId();
-    lastSaveTime = getMillisecondsSinceEpoch();
-    load();
-*/
+    return upperBound(buckets.size() - 1);
 }
 
-Statistics &Statistics::getInstance() {
-    if (!instance) {
-        instance = new Statistics();
+Statistics::MetricCounts::MetricCounts() : sum(0) {
+    for (auto &bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+Statistics::MergedCounts::MergedCounts() : sum(0) {
+    buckets.fill(0);
+}
+
+Statistics::ThreadCounts::ThreadCounts() : retired(false) {
+    for (auto &metric : metrics) {
+        metric.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+Statistics::ThreadCounts::~ThreadCounts() {
+    for (auto &metric : metrics) {
+        delete metric.load(std::memory_order_relaxed);
+    }
+}
+
+Statistics::ThreadRegistration::~ThreadRegistration() {
+    if (counts) {
+        counts->retired.store(true, std::memory_order_release);
+    }
+}
+
+Statistics::Statistics() {
+    for (auto &counter : counters) {
+        counter.store(0, std::memory_order_relaxed);
     }
-    
+}
+
+Statistics &Statistics::getInstance() {
+    // never destroyed, threads may still record while the server shuts down
+    static Statistics *instance = new Statistics();
     return *instance;
 }
 
-void Statistics::startTimer(const std::string &type) {
-/*
-    int intType;
+Metric Statistics::registerMetric(const std::string &name) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    const auto it = metricIds.find(name);
 
-    try {
-        intType = typeToInt(type);
-    } catch (std::out_of_range &e) {
-        return;
+    if (it != metricIds.end()) {
+        return Metric(it->second);
+    }
+
+    const auto id = metricCount.load(std::memory_order_relaxed);
+
+    if (id >= MAX_METRICS) {
+        Logger::error(LogFacility::Other) << "too many statistics, not recording " << name << Log::end;
+        return Metric();
     }
 
-    startTimes[intType] = getMillisecondsSinceEpoch();
-*/
+    metricNames[id] = name;
+    metricIds.emplace(name, id);
+    metricCount.store(id + 1, std::memory_order_release);
+    return Metric(id);
 }
 
-void Statistics::stopTimer(const std::string &type) {
-/*
-    int intType;
+Statistics::ThreadCounts &Statistics::threadCounts() {
+    thread_local ThreadRegistration registration;
 
-    try {
-        intType = typeToInt(type);
-    } catch (std::out_of_range &e) {
+    if (!registration.counts) {
+        registration.counts = std::make_shared<ThreadCounts>();
+        std::lock_guard<std::mutex> lock(registryMutex);
+        threads.push_back(registration.counts);
+    }
+
+    return *registration.counts;
+}
+
+void Statistics::record(Metric metric, uint64_t microseconds) {
+    if (!metric.valid()) {
         return;
-    }   
+    }
+
+    auto &counts = threadCounts();
+    auto *metricCounts = counts.metrics[metric.id].load(std::memory_order_relaxed);
 
-    long now = getMillisecondsSinceEpoch();
-    int duration = static_cast<int>(now - startTimes[intType]);
-    startTimes[intType] = now;
-    auto playersOnline = World::get()->Players.size();
+    if (!metricCounts) {
+        metricCounts = new MetricCounts();
+        counts.metrics[metric.id].store(metricCounts, std::memory_order_release);
+    }
+
+    // this thread is the only writer, no atomic read-modify-write needed
+    auto &bucket = metricCounts->buckets[Histogram::bucketOf(microseconds)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    metricCounts->sum.store(metricCounts->sum.load(std::memory_order_relaxed) + microseconds, std::memory_order_relaxed);
+}
 
-    while (statistics[intType].size() <= playersOnline) {
-        statistics[intType].emplace_back();
+Counter Statistics::registerCounter(const std::string &name) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    const auto it = counterIds.find(name);
+
+    if (it != counterIds.end()) {
+        return Counter(it->second);
     }
-    
-    ++statistics[intType][playersOnline][duration];
 
-    if (now - lastSaveTime > SAVE_INTERVAL) {
-        lastSaveTime = now;
+    const auto id = counterCount.load(std::memory_order_relaxed);
 
-        statistics.swap(statisticsSave);
-        std::thread t(&Statistics::save, this);
-        t.detach();
+    if (id >= MAX_COUNTERS) {
+        Logger::error(LogFacility::Other) << "too many counters, not counting " << name << Log::end;
+        return Counter();
     }
-*/
+
+    counterNames[id] = name;
+    counterIds.emplace(name, id);
+    counterCount.store(id + 1, std::memory_order_release);
+    return Counter(id);
 }
 
-void Statistics::logTime(const std::string& type, int duration) {
-/*
-    int intType;
+void Statistics::increment(Counter counter, uint64_t value) {
+    if (counter.valid()) {
+        counters[counter.id].fetch_add(value, std::memory_order_relaxed);
+    }
+}
 
-    try {
-        intType = typeToInt(type);
-    } catch (std::out_of_range &e) {
-        return;
+void Statistics::registerGauge(const std::string &name, std::function<double()> sampler) {
+    std::lock_guard<std::mutex> lock(gaugeMutex);
+
+    for (auto &gauge : gauges) {
+        if (gauge.first == name) {
+            gauge.second = std::move(sampler);
+            return;
+        }
     }
-    auto playersOnline = World::get()->Players.size();
 
-    while (statistics[intType].size() <= playersOnline) {
-        statistics[intType].emplace_back();
+    gauges.emplace_back(name, std::move(sampler));
+}
+
+std::vector<std::pair<std::string, uint64_t>> Statistics::getCounters() {
+    const auto count = counterCount.load(std::memory_order_acquire);
+    std::vector<std::pair<std::string, uint64_t>> result;
+    result.reserve(count);
+
+    for (size_t id = 0; id < count; ++id) {
+        result.emplace_back(counterNames[id], counters[id].load(std::memory_order_relaxed));
     }
 
-    ++statistics[intType][playersOnline][duration];
+    return result;
+}
+
+std::vector<std::pair<std::string, double>> Statistics::getGauges() {
+    std::vector<std::pair<std::string, double>> result;
+    result.emplace_back("players_online", static_cast<double>(playersOnline.load(std::memory_order_relaxed)));
 
-    long now = getMillisecondsSinceEpoch();
-    if (now - lastSaveTime > SAVE_INTERVAL) {
-        lastSaveTime = now;
+    std::lock_guard<std::mutex> lock(gaugeMutex);
 
-        statistics.swap(statisticsSave);
-        std::thread t(&Statistics::save, this);
-        t.detach();
+    for (const auto &gauge : gauges) {
+        result.emplace_back(gauge.first, gauge.second());
+    }
+
+    return result;
+}
+
+void Statistics::setPlayersOnline(size_t players) {
+    playersOnline.store(players, std::memory_order_relaxed);
+}
+
+void Statistics::collect() {
+    std::vector<std::shared_ptr<ThreadCounts>> current;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        current = threads;
+    }
+
+    const auto metrics = metricCount.load(std::memory_order_acquire);
+    const auto players = playersOnline.load(std::memory_order_relaxed);
+
+    if (unsaved.size() < metrics) {
+        unsaved.resize(metrics);
+    }
+
+    std::vector<ThreadCounts *> finished;
+
+    for (const auto &thread : current) {
+        const bool retired = thread->retired.load(std::memory_order_acquire);
+
+        for (size_t id = 0; id < metrics; ++id) {
+            const auto *metricCounts = thread->metrics[id].load(std::memory_order_acquire);
+
+            if (!metricCounts) {
+                continue;
+            }
+
+            auto &merged = thread->merged[id];
+            auto &total = totals[id];
+
+            if (!merged) {
+                merged = std::make_unique<MergedCounts>();
+            }
+
+            if (!total) {
+                total = std::make_unique<MergedCounts>();
+            }
+
+            for (size_t bucket = 0; bucket < Histogram::BUCKETS; ++bucket) {
+                const auto value = metricCounts->buckets[bucket].load(std::memory_order_relaxed);
+                const auto delta = value - merged->buckets[bucket];
+
+                if (delta > 0) {
+                    merged->buckets[bucket] = value;
+                    total->buckets[bucket] += delta;
+
+                    if (unsaved[id].size() <= players) {
+                        unsaved[id].resize(players + 1);
+                    }
+
+                    unsaved[id][players][Histogram::lowerBound(bucket) / 1000] += delta;
+                }
+            }
+
+            const auto sum = metricCounts->sum.load(std::memory_order_relaxed);
+            total->sum += sum - merged->sum;
+            merged->sum = sum;
+        }
+
+        if (retired) {
+            finished.push_back(thread.get());
+        }
+    }
+
+    if (!finished.empty()) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        threads.erase(std::remove_if(threads.begin(), threads.end(), [&finished](const std::shared_ptr<ThreadCounts> &thread) {
+            return std::find(finished.begin(), finished.end(), thread.get()) != finished.end();
+        }), threads.end());
     }
-*/
+}
+
+std::vector<Histogram> Statistics::getHistograms() {
+    std::lock_guard<std::mutex> lock(collectMutex);
+    collect();
+
+    const auto metrics = metricCount.load(std::memory_order_acquire);
+    std::vector<Histogram> histograms(metrics);
+
+    for (size_t id = 0; id < metrics; ++id) {
+        auto &histogram = histograms[id];
+        histogram.name = metricNames[id];
+        histogram.buckets.assign(Histogram::BUCKETS, 0);
+
+        if (totals[id]) {
+            std::copy(totals[id]->buckets.begin(), totals[id]->buckets.end(), histogram.buckets.begin());
+            histogram.sum = totals[id]->sum;
+
+            for (const auto count : histogram.buckets) {
+                histogram.count += count;
+            }
+        }
+    }
+
+    return histograms;
+}
+
+void Statistics::saveAsync() {
+    StatTypes statistics;
+    std::vector<std::string> names;
+
+    {
+        std::lock_guard<std::mutex> lock(collectMutex);
+        collect();
+        statistics.swap(unsaved);
+        names.assign(metricNames.begin(), metricNames.begin() + statistics.size());
+    }
+
+    if (!Config::instance().save_statistics || statistics.empty()) {
+        return;
+    }
+
+    std::thread t(&Statistics::save, this, std::move(statistics), std::move(names));
+    t.detach();
 }
 
 int Statistics::typeToInt(const std::string &type) {
@@ -219,17 +436,27 @@ void Statistics::load() {
         int bin = row["stat_bin"].as<int>();
         int count = row["stat_count"].as<int>();
 
-        while (statisticsDB[type].size() <= static_cast<size_t>(players_online)) {
-            statisticsDB[type].emplace_back();
-        }
-
         statisticsDB[type][players_online][bin] = count;
     }
 }
 
-void Statistics::save() {
+void Statistics::save(StatTypes statistics, std::vector<std::string> names) {
     using namespace Database;
 
+    std::lock_guard<std::mutex> lock(saveMutex);
+
+    try {
+        if (!loaded) {
+            versionId = getVersionId();
+            loadTypes();
+            load();
+            loaded = true;
+        }
+    } catch (std::exception &e) {
+        Logger::error(LogFacility::Other) << "loading statistics caught exception: " << e.what() << Log::end;
+        return;
+    }
+
     auto connection = ConnectionManager::getInstance().getConnection();
 
     try {
@@ -241,12 +468,19 @@ void Statistics::save() {
         const auto countColumn = insertQuery.addColumn("stat_count");
         insertQuery.addServerTable("statistics");
 
-        int currentType = 0;
-        for (auto &types : statisticsSave) {
+        for (size_t metric = 0; metric < statistics.size(); ++metric) {
+            int currentType;
+
+            try {
+                currentType = typeToInt(names[metric]);
+            } catch (std::out_of_range &e) {
+                continue;
+            }
+
             auto &typeDB = statisticsDB[currentType];
             int players = 0;
 
-            for (auto &bins : types) {
+            for (auto &bins : statistics[metric]) {
                 auto &playersDB = typeDB[players];
 
                 for (const auto &bin : bins) {
@@ -276,11 +510,8 @@ void Statistics::save() {
                     }
                 }
 
-                bins.clear();
                 ++players;
             }
-
-            ++currentType;
         }
 
         insertQuery.execute();
@@ -291,10 +522,4 @@ void Statistics::save() {
 
 }
 
-long Statistics::getMillisecondsSinceEpoch() const {
-    using namespace std::chrono;
-    return duration_cast<milliseconds>(high_resolution_clock::now().time_since_epoch()).count();
-}
-
 }
-
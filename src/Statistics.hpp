@@ -21,56 +21,228 @@
 #ifndef _STATISTICS_HPP_
 #define _STATISTICS_HPP_
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
-#include <limits>
 #include <vector>
 #include <unordered_map>
 
 namespace Statistic {
 
+/**
+* handle of a metric registered with Statistics, cheap to copy and to record to
+*/
+class Metric {
+public:
+    Metric() = default;
+
+    bool valid() const {
+        return id != invalid;
+    }
+
+private:
+    friend class Statistics;
+
+    explicit Metric(uint16_t id) : id(id) {}
+
+    static const uint16_t invalid = 0xFFFF;
+    uint16_t id = invalid;
+};
+
+/**
+* handle of a counter registered with Statistics
+*/
+class Counter {
+public:
+    Counter() = default;
+
+    bool valid() const {
+        return id != invalid;
+    }
+
+private:
+    friend class Statistics;
+
+    explicit Counter(uint16_t id) : id(id) {}
+
+    static const uint16_t invalid = 0xFFFF;
+    uint16_t id = invalid;
+};
+
+/**
+* merged latency histogram of one metric, values are in microseconds
+*
+* buckets are log-linear: eight buckets per power of two, so every bucket
+* is at most 12.5% wide relative to its lower bound
+*/
+struct Histogram {
+    static const int SUB_BUCKET_BITS = 3;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const int MAX_EXPONENT = 36;
+    static const int BUCKETS = (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    static size_t bucketOf(uint64_t value);
+    static uint64_t lowerBound(size_t bucket);
+    static uint64_t upperBound(size_t bucket);
+
+    // value below which the given fraction of all recorded values lies
+    uint64_t percentile(double fraction) const;
+
+    std::string name;
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    std::vector<uint64_t> buckets;
+};
+
+/**
+* collects latency histograms from all threads
+*
+* metrics are registered once by name, recording to the returned handle
+* neither locks nor allocates after the first value of a thread: every
+* thread writes to its own histograms, which are merged periodically.
+* Merged values are also kept per number of players online for saving.
+*/
 class Statistics {
 public:
     static Statistics &getInstance();
 
-    void startTimer(const std::string &type);
-    // not thread-safe, collect statistics in main thread only for now
-    void stopTimer(const std::string &type);
+    // thread-safe, registering a name again returns the same handle
+    Metric registerMetric(const std::string &name);
+
+    // thread-safe and lock-free
+    void record(Metric metric, uint64_t microseconds);
+
+    template<class Rep, class Period>
+    void record(Metric metric, std::chrono::duration<Rep, Period> duration) {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        record(metric, us > 0 ? static_cast<uint64_t>(us) : 0);
+    }
+
+    // thread-safe, registering a name again returns the same handle
+    Counter registerCounter(const std::string &name);
+
+    // thread-safe and lock-free
+    void increment(Counter counter, uint64_t value = 1);
+
+    // sampler is called from the thread reading the gauges and has to be thread-safe
+    void registerGauge(const std::string &name, std::function<double()> sampler);
+
+    // the merged values of the next collect are attributed to this number of players
+    void setPlayersOnline(size_t players);
+
+    // merges the values of all threads and returns the totals since startup
+    std::vector<Histogram> getHistograms();
+
+    std::vector<std::pair<std::string, uint64_t>> getCounters();
+    std::vector<std::pair<std::string, double>> getGauges();
+
+    // merges the values of all threads and stores them in the database in the background
+    void saveAsync();
 
-    // not thread-safe, collect statistics in main thread only for now
-    void logTime(const std::string& type, int duration);
 private:
     Statistics();
     Statistics(const Statistics &) = delete;
     Statistics &operator=(const Statistics &) = delete;
 
-    typedef std::unordered_map<int, int> BinToCount;
+    static const size_t MAX_METRICS = 256;
+    static const size_t MAX_COUNTERS = 64;
+
+    struct MetricCounts {
+        std::array<std::atomic<uint64_t>, Histogram::BUCKETS> buckets;
+        std::atomic<uint64_t> sum;
+
+        MetricCounts();
+    };
+
+    struct MergedCounts {
+        std::array<uint64_t, Histogram::BUCKETS> buckets;
+        uint64_t sum;
+
+        MergedCounts();
+    };
+
+    // written by exactly one thread, read by collect
+    struct ThreadCounts {
+        std::array<std::atomic<MetricCounts *>, MAX_METRICS> metrics;
+        std::atomic<bool> retired;
+        // values already merged, only accessed under collectMutex
+        std::array<std::unique_ptr<MergedCounts>, MAX_METRICS> merged;
+
+        ThreadCounts();
+        ~ThreadCounts();
+    };
+
+    struct ThreadRegistration {
+        std::shared_ptr<ThreadCounts> counts;
+        ~ThreadRegistration();
+    };
+
+    ThreadCounts &threadCounts();
+    // requires collectMutex to be held
+    void collect();
+
+    std::mutex registryMutex;
+    std::unordered_map<std::string, uint16_t> metricIds;
+    std::array<std::string, MAX_METRICS> metricNames;
+    std::atomic<size_t> metricCount = {0};
+    std::vector<std::shared_ptr<ThreadCounts>> threads;
+
+    std::unordered_map<std::string, uint16_t> counterIds;
+    std::array<std::string, MAX_COUNTERS> counterNames;
+    std::array<std::atomic<uint64_t>, MAX_COUNTERS> counters;
+    std::atomic<size_t> counterCount = {0};
+
+    std::mutex gaugeMutex;
+    std::vector<std::pair<std::string, std::function<double()>>> gauges;
+
+    std::atomic<size_t> playersOnline = {0};
+
+    typedef std::map<int, uint64_t> BinToCount;
     typedef std::vector<BinToCount> PlayerData;
     typedef std::vector<PlayerData> StatTypes;
 
-    static Statistics *instance;
-    
-    int versionId;
+    std::mutex collectMutex;
+    std::array<std::unique_ptr<MergedCounts>, MAX_METRICS> totals;
+    // merged since the last save, indexed by metric, players online and millisecond bin
+    StatTypes unsaved;
 
+    std::mutex saveMutex;
+    bool loaded = false;
+    int versionId = 0;
     std::unordered_map<std::string, int> types;
-
-    StatTypes statisticsDB;
-    StatTypes statistics;
-    StatTypes statisticsSave;
-    
-    std::vector<long> startTimes;
-    static const long SAVE_INTERVAL = 60000; // one minute
-    static const int DEFAULT_PLAYERS = 50;
-    long lastSaveTime;
+    std::map<int, std::map<int, BinToCount>> statisticsDB;
 
     void loadTypes();
     int typeToInt(const std::string &type);
     void load();
-    void save();
+    void save(StatTypes statistics, std::vector<std::string> names);
     int getVersionId();
-    long getMillisecondsSinceEpoch() const;
+};
+
+/**
+* records the time from construction to destruction
+*/
+class StopWatch {
+public:
+    explicit StopWatch(Metric metric) : metric(metric), start(std::chrono::steady_clock::now()) {}
+    StopWatch(const StopWatch &) = delete;
+    StopWatch &operator=(const StopWatch &) = delete;
+
+    ~StopWatch() {
+        Statistics::getInstance().record(metric, std::chrono::steady_clock::now() - start);
+    }
+
+private:
+    Metric metric;
+    std::chrono::steady_clock::time_point start;
 };
 
 }
 
 #endif
-
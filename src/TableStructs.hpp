@@ -44,11 +44,6 @@ struct ItemStruct {
     TYPE_OF_MAX_STACK MaxStack = 1;
     TYPE_OF_BUY_STACK BuyStack = 1;
     bool rotsInInventory = false;
-    TYPE_OF_ENGLISH serverName = "";
-    TYPE_OF_ENGLISH English = "";
-    TYPE_OF_GERMAN German = "";
-    TYPE_OF_ENGLISH EnglishDescription = "";
-    TYPE_OF_GERMAN GermanDescription = "";
     int16_t Rareness = 1;
     TYPE_OF_ITEMLEVEL Level = 0;
 
@@ -57,6 +52,15 @@ struct ItemStruct {
     }
 };
 
+// names are kept apart from ItemStruct, which is read in every weight and ageing calculation
+struct ItemNames {
+    TYPE_OF_ENGLISH serverName = "";
+    TYPE_OF_ENGLISH English = "";
+    TYPE_OF_GERMAN German = "";
+    TYPE_OF_ENGLISH EnglishDescription = "";
+    TYPE_OF_GERMAN GermanDescription = "";
+};
+
 struct TilesModificatorStruct {
     unsigned char Modificator;
 };
@@ -73,6 +73,11 @@ bool WaypointList::recalcStepList() {
     return (!steplist.empty());
 }
 
+void WaypointList::setStepList(std::list<direction> &&steps) {
+    checkPosition();
+    steplist = std::move(steps);
+}
+
 bool WaypointList::makeMove() {
     if (steplist.empty()) {
         if (!recalcStepList()) {
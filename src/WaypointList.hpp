@@ -37,6 +37,8 @@ public:
     void clear();
     bool makeMove();
     bool recalcStepList();
+    // use steps computed in advance towards the next waypoint instead of recalculating them
+    void setStepList(std::list<direction> &&steps);
 
 private:
     std::list<position> positions;
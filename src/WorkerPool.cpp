@@ -0,0 +1,101 @@
+//  illarionserver - server for the game Illarion
+//  Copyright 2011 Illarion e.V.
+//
+//  This file is part of illarionserver.
+//
+//  illarionserver is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  illarionserver is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with illarionserver.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "WorkerPool.hpp"
+
+WorkerPool::WorkerPool(size_t threadCount) {
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads.emplace_back(&WorkerPool::work, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    jobAvailable.notify_all();
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+void WorkerPool::parallelFor(size_t count, const std::function<void(size_t)> &function) {
+    if (threads.empty() || count < 2) {
+        for (size_t i = 0; i < count; ++i) {
+            function(i);
+        }
+
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &function;
+        jobCount = count;
+        nextIndex.store(0, std::memory_order_relaxed);
+        busyWorkers = threads.size();
+        ++generation;
+    }
+
+    jobAvailable.notify_all();
+    runJob();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    jobFinished.wait(lock, [this] { return busyWorkers == 0; });
+    job = nullptr;
+}
+
+void WorkerPool::work() {
+    uint64_t finishedGeneration = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAvailable.wait(lock, [this, finishedGeneration] { return stopping || generation != finishedGeneration; });
+
+            if (stopping) {
+                return;
+            }
+
+            finishedGeneration = generation;
+        }
+
+        runJob();
+
+        bool lastWorker;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            lastWorker = --busyWorkers == 0;
+        }
+
+        if (lastWorker) {
+            jobFinished.notify_one();
+        }
+    }
+}
+
+void WorkerPool::runJob() {
+    size_t index;
+
+    while ((index = nextIndex.fetch_add(1, std::memory_order_relaxed)) < jobCount) {
+        (*job)(index);
+    }
+}
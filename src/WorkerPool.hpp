@@ -0,0 +1,74 @@
+//  illarionserver - server for the game Illarion
+//  Copyright 2011 Illarion e.V.
+//
+//  This file is part of illarionserver.
+//
+//  illarionserver is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  illarionserver is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with illarionserver.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef _WORKER_POOL_HPP_
+#define _WORKER_POOL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+* fixed set of threads helping the game thread with data parallel work
+*
+* the game thread hands out one job at a time and takes part in it,
+* so a pool without threads simply runs everything on the caller
+*/
+class WorkerPool {
+public:
+    explicit WorkerPool(size_t threadCount);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    /**
+    * calls function for every index below count and returns once all calls have finished
+    * function must not throw and must only share read-only state between indices
+    */
+    void parallelFor(size_t count, const std::function<void(size_t)> &function);
+
+    size_t size() const {
+        return threads.size();
+    }
+
+private:
+    void work();
+    void runJob();
+
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    std::condition_variable jobFinished;
+    uint64_t generation = 0;
+    size_t busyWorkers = 0;
+    bool stopping = false;
+
+    const std::function<void(size_t)> *job = nullptr;
+    size_t jobCount = 0;
+    std::atomic<size_t> nextIndex = {0};
+};
+
+#endif
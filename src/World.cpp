@@ -25,6 +25,7 @@
 #include <ctime>
 #include <memory>
 #include <regex>
+#include <thread>
 #include <sys/types.h>
 
 #include "Logger.hpp"
@@ -46,6 +47,7 @@
 #include "data/SkillTable.hpp"
 #include "data/WeaponObjectTable.hpp"
 
+#include "script/LuaGarbageCollector.hpp"
 #include "script/LuaLogoutScript.hpp"
 #include "script/LuaNPCScript.hpp"
 #include "script/LuaWeaponScript.hpp"
@@ -59,7 +61,7 @@
 
 #include "Statistics.hpp"
 
-extern ScheduledScriptsTable *scheduledScripts;
+extern std::unique_ptr<ScheduledScriptsTable> scheduledScripts;
 extern MonsterTable *monsterDescriptions;
 extern std::shared_ptr<LuaLogoutScript> logoutScript;
 extern std::shared_ptr<LuaWeaponScript> standardFightingScript;
@@ -184,18 +186,33 @@ void World::turntheworld() {
         usedAP += ap;
 
         using namespace Statistic;
+        static const auto playerCycle = Statistics::getInstance().registerMetric("cycle player");
+        static const auto npcCycle = Statistics::getInstance().registerMetric("cycle npc");
+        static const auto effectCycle = Statistics::getInstance().registerMetric("cycle effects");
 
-        Statistics::getInstance().startTimer("cycle player");
-        checkPlayers();
-        Statistics::getInstance().stopTimer("cycle player");
+        Statistics::getInstance().setPlayersOnline(Players.size());
 
-        Statistics::getInstance().startTimer("cycle monster");
-        checkMonsters();
-        Statistics::getInstance().stopTimer("cycle monster");
+        {
+            StopWatch stopWatch(playerCycle);
+            checkPlayers();
+        }
+
+        {
+            StopWatch stopWatch(effectCycle);
+            checkEffects();
+        }
+
+        if (ap > 1) {
+            --ap;
+        }
+
+        // monsters take their turns in the monster_turn task
+        pendingMonsterAP += ap;
 
-        Statistics::getInstance().startTimer("cycle npc");
+        StopWatch stopWatch(npcCycle);
         checkNPC();
-        Statistics::getInstance().stopTimer("cycle npc");
+        sendPendingMoves();
+        sendChangedFields();
     }
 }
 
@@ -219,7 +236,6 @@ void World::checkPlayers() {
                 player.workoutCommands();
                 player.checkFightMode();
                 player.ltAction->checkAction();
-                player.effects.checkEffects();
             }
             // User timed out.
             else {
@@ -241,7 +257,7 @@ void World::checkPlayers() {
 
             logoutScript->onLogout(playerPointer);
 
-            PlayerManager::get().getLogOutPlayers().push_back(playerPointer);
+            PlayerManager::get().logoutPlayer(playerPointer);
             sendRemoveCharToVisiblePlayers(player.getId(), pos);
             lostPlayers.push_back(playerPointer);
         }
@@ -253,21 +269,23 @@ void World::checkPlayers() {
 }
 
 void World::checkPlayerImmediateCommands() {
-    std::unique_lock<std::mutex> lock(immediatePlayerCommandsMutex);
-    while (!immediatePlayerCommands.empty()) {
-	auto player = immediatePlayerCommands.front();
-	immediatePlayerCommands.pop();
-	lock.unlock();
-
-        if (player->Connection->online)
-		player->workoutCommands();
-	lock.lock();
+    Player *player = nullptr;
+
+    while (immediatePlayerCommands.try_pop(player)) {
+        if (player->Connection->online) {
+            player->workoutCommands();
+        }
     }
 }
 
 void World::addPlayerImmediateActionQueue(Player* player) {
-    std::unique_lock<std::mutex> lock(immediatePlayerCommandsMutex);
-    immediatePlayerCommands.push(player);
+    // called from the network threads, never block them: if the queue is full
+    // the commands are still processed by checkPlayers during the next turn
+    if (!immediatePlayerCommands.try_push(player)) {
+        static const auto deferred = Statistic::Statistics::getInstance().registerCounter("immediate_commands_deferred");
+        Statistic::Statistics::getInstance().increment(deferred);
+        Logger::warn(LogFacility::World) << "Immediate command queue full, commands of player " << player->getId() << " wait for the next turn" << Log::end;
+    }
 }
 
 void World::invalidatePlayerDialogs() {
@@ -331,30 +349,58 @@ bool World::initRespawns() {
 
 }
 
-void World::checkMonsters() {
-    if (monstertimer.next()) {
-        if (isSpawnEnabled()) {
-            for (auto &spawn : SpawnList) {
-                spawn.spawn();
+bool World::checkMonsters(std::chrono::steady_clock::time_point deadline) {
+    if (monsterCycleIndex >= monsterCycle.size()) {
+        if (pendingMonsterAP <= 0) {
+            return true;
+        }
+
+        // start a new cycle in which every monster takes one turn
+        if (monstertimer.next()) {
+            if (isSpawnEnabled()) {
+                for (auto &spawn : SpawnList) {
+                    spawn.spawn();
+                }
+            } else {
+                Logger::info(LogFacility::World) << "World::checkMonsters() spawning disabled!" << Log::end;
             }
-        } else {
-            Logger::info(LogFacility::World) << "World::checkMonsters() spawning disabled!" << Log::end;
         }
-    }
 
-    if (ap > 1) {
-        --ap;
+        monsterCycleAP = pendingMonsterAP;
+        pendingMonsterAP = 0;
+
+        sleepingMonsters.store(sleepingMonstersInCycle, std::memory_order_relaxed);
+        sleepingMonstersInCycle = 0;
+
+        monsterCycle.clear();
+        monsterCycle.reserve(Monsters.size());
+        Monsters.for_each([this](Monster *monster) {
+            monsterCycle.push_back(monster->getId());
+        });
+        monsterCycleIndex = 0;
     }
 
     std::vector<Monster *> deadMonsters;
 
-    Monsters.for_each([this, &deadMonsters](Monster *monsterPointer) {
+    const auto monsterTurn = [this, &deadMonsters](Monster *monsterPointer, MonsterPlan &plan) {
         Monster &monster = *monsterPointer;
 
         if (monster.isAlive()) {
-            monster.increaseActionPoints(ap);
-            monster.increaseFightPoints(ap);
-            monster.effects.checkEffects();
+            if (plan.asleep) {
+                // counted here since plans which miss the deadline are made again
+                ++sleepingMonstersInCycle;
+                monster.sleep(monsterCycleAP);
+
+                if (monster.needsCatchUp()) {
+                    monster.catchUp();
+                }
+
+                return;
+            }
+
+            monster.catchUp();
+            monster.increaseActionPoints(monsterCycleAP);
+            monster.increaseFightPoints(monsterCycleAP);
 
             bool foundMonster = monsterDescriptions->exists(monster.getMonsterType());
             const auto &monStruct = (*monsterDescriptions)[monster.getMonsterType()];
@@ -365,18 +411,7 @@ void World::checkMonsters() {
                         monster.lastTargetSeen = false;
                     }
 
-                    Item itl = monster.GetItemAt(LEFT_TOOL);
-                    Item itr = monster.GetItemAt(RIGHT_TOOL);
-
-                    uint16_t range=1;
-
-                    if (Data::WeaponItems.exists(itr.getId())) {
-                        range = Data::WeaponItems[itr.getId()].Range;
-                    } else if (Data::WeaponItems.exists(itl.getId())) {
-                        range = Data::WeaponItems[itl.getId()].Range;;
-                    }
-
-                    const auto temp = getTargetsInRange(monster.getPosition(), range);
+                    const auto temp = getPlannedTargets(plan, monster, getWeaponRange(monster));
                     bool has_attacked=false;
                     Character *target = nullptr;
 
@@ -412,7 +447,7 @@ void World::checkMonsters() {
                     }
 
                     if (!has_attacked) {
-                        const auto temp = getTargetsInRange(monster.getPosition(), MONSTERVIEWRANGE);
+                        const auto temp = getPlannedTargets(plan, monster, MONSTERVIEWRANGE);
 
                         bool makeRandomStep=true;
 
@@ -443,7 +478,12 @@ void World::checkMonsters() {
                             }
                         } else if (monster.lastTargetSeen) {
                             makeRandomStep=false;
-                            monster.performStep(monster.lastTargetPosition);
+
+                            if (plan.hasPath && plan.pathGoal == monster.lastTargetPosition && plan.origin == monster.getPosition()) {
+                                monster.performStep(monster.lastTargetPosition, std::move(plan.path));
+                            } else {
+                                monster.performStep(monster.lastTargetPosition);
+                            }
                         }
 
                         if (makeRandomStep) {
@@ -541,18 +581,7 @@ void World::checkMonsters() {
                         }
                     }
                 } else {
-                    Item itl = monster.GetItemAt(LEFT_TOOL);
-                    Item itr = monster.GetItemAt(RIGHT_TOOL);
-
-                    uint16_t range=1;
-
-                    if (Data::WeaponItems.exists(itr.getId())) {
-                        range = Data::WeaponItems[itr.getId()].Range;
-                    } else if (Data::WeaponItems.exists(itl.getId())) {
-                        range = Data::WeaponItems[itl.getId()].Range;;
-                    }
-
-                    const auto temp = getTargetsInRange(monster.getPosition(), range);
+                    const auto temp = getPlannedTargets(plan, monster, getWeaponRange(monster));
 
                     if (!temp.empty()) {
                         Character *target = nullptr;
@@ -570,7 +599,7 @@ void World::checkMonsters() {
                         }
                     }
 
-                    const auto temp2 = getTargetsInRange(monster.getPosition(), MONSTERVIEWRANGE);
+                    const auto temp2 = getPlannedTargets(plan, monster, MONSTERVIEWRANGE);
 
                     if (!temp2.empty()) {
                         Character *target = nullptr;
@@ -600,7 +629,36 @@ void World::checkMonsters() {
         } else {
             deadMonsters.push_back(monsterPointer);
         }
-    });
+    };
+
+    const auto firstIndex = monsterCycleIndex;
+    bool deadlinePassed = false;
+
+    while (!deadlinePassed && monsterCycleIndex < monsterCycle.size()) {
+        const size_t batchSize = std::min<size_t>(MONSTER_PLAN_BATCH, monsterCycle.size() - monsterCycleIndex);
+        planMonsterTurns(monsterCycleIndex, batchSize);
+
+        // turns are taken one after another in cycle order, plans of monsters
+        // not reached before the deadline are thrown away
+        for (auto &plan : monsterPlans) {
+            // every slice makes progress, even if the deadline already passed
+            if (monsterCycleIndex > firstIndex && std::chrono::steady_clock::now() >= deadline) {
+                deadlinePassed = true;
+                break;
+            }
+
+            ++monsterCycleIndex;
+
+            if (monsterPlansStale) {
+                plan.prepared = false;
+                plan.hasPath = false;
+            }
+
+            if (plan.monster) {
+                monsterTurn(plan.monster, plan);
+            }
+        }
+    }
 
     for (const auto &monster : deadMonsters) {
         killMonster(monster->getId());
@@ -622,8 +680,130 @@ void World::checkMonsters() {
     }
 
     newMonsters.clear();
+    sendPendingMoves();
+
+    return monsterCycleIndex >= monsterCycle.size();
+}
+
+
+void World::planMonsterTurns(size_t first, size_t count) {
+    if (!monsterPlanners) {
+        int workers = Config::instance().monster_ai_workers;
+
+        if (workers < 0) {
+            workers = std::min<int>(std::thread::hardware_concurrency(), MAX_MONSTER_AI_WORKERS + 1) - 1;
+        }
+
+        monsterPlanners = std::make_unique<WorkerPool>(std::max(workers, 0));
+    }
+
+    monsterPlans.resize(count);
+    monsterPlansStale = false;
+
+    for (size_t i = 0; i < count; ++i) {
+        auto &plan = monsterPlans[i];
+        // monsters might have been removed since the cycle started
+        plan.monster = Monsters.find(monsterCycle[first + i]);
+        plan.asleep = plan.monster && isMonsterAsleep(*plan.monster);
+        plan.prepared = false;
+        plan.hasPath = false;
+        plan.targets.clear();
+        plan.path.clear();
+    }
+
+    monsterPlanners->parallelFor(count, [this](size_t i) {
+        planMonsterTurn(monsterPlans[i]);
+    });
 }
 
+void World::planMonsterTurn(MonsterPlan &plan) const {
+    Monster *monster = plan.monster;
+
+    if (!monster || plan.asleep || !monster->isAlive() || !monsterDescriptions->exists(monster->getMonsterType())) {
+        return;
+    }
+
+    // monsters with their own script might change the world in ways we cannot predict
+    if ((*monsterDescriptions)[monster->getMonsterType()].script) {
+        return;
+    }
+
+    try {
+        plan.origin = monster->getPosition();
+        // monsters acting earlier in the batch walk at most one field, so one field more
+        // catches all of them that might have come into range until this monster's turn,
+        // characters jumping further make moveTo mark the plans stale
+        plan.targetRadius = std::max<int>(getWeaponRange(*monster), MONSTERVIEWRANGE);
+        plan.targets = getTargetsInRange(plan.origin, plan.targetRadius + 1);
+        plan.prepared = true;
+
+        // finding the way back to the last known target position is the expensive part
+        // of a monster without anything in sight, see Monster::performStep
+        if ((!monster->canAttack() || getPlannedTargets(plan, *monster, MONSTERVIEWRANGE).empty()) && !monster->getOnRoute() && monster->lastTargetSeen
+            && !(plan.origin == monster->lastTargetPosition)) {
+            position currentTarget;
+
+            if (!(monster->waypoints.getNextWaypoint(currentTarget) && currentTarget == monster->lastTargetPosition)) {
+                plan.pathGoal = monster->lastTargetPosition;
+                monster->getStepList(plan.pathGoal, plan.path);
+                plan.hasPath = true;
+            }
+        }
+    } catch (...) {
+        // the turn itself will do the work again on the game thread
+        plan.prepared = false;
+        plan.hasPath = false;
+    }
+}
+
+bool World::isMonsterAsleep(const Monster &monster) const {
+    // monsters on a route follow their script and must keep moving
+    if (monster.getOnRoute()) {
+        return false;
+    }
+
+    Range range;
+    range.radius = MONSTER_WAKE_RANGE;
+    return Players.findAllCharactersInRangeOf(monster.getPosition(), range).empty();
+}
+
+std::vector<Character *> World::getPlannedTargets(const MonsterPlan &plan, const Monster &monster, int range) const {
+    const auto &pos = monster.getPosition();
+
+    if (!plan.prepared || range > plan.targetRadius || !(plan.origin == pos)) {
+        return getTargetsInRange(pos, range);
+    }
+
+    // earlier turns of this batch might have moved or killed some of the targets
+    std::vector<Character *> targets;
+
+    for (const auto &target : plan.targets) {
+        const auto &targetPos = target->getPosition();
+
+        if (target->isAlive() && targetPos.z == pos.z
+            && abs(targetPos.x - pos.x) <= range && abs(targetPos.y - pos.y) <= range
+            && !(target->getType() == Character::monster && targetPos == pos)) {
+            targets.push_back(target);
+        }
+    }
+
+    return targets;
+}
+
+uint16_t World::getWeaponRange(Monster &monster) {
+    Item itl = monster.GetItemAt(LEFT_TOOL);
+    Item itr = monster.GetItemAt(RIGHT_TOOL);
+
+    uint16_t range=1;
+
+    if (Data::WeaponItems.exists(itr.getId())) {
+        range = Data::WeaponItems[itr.getId()].Range;
+    } else if (Data::WeaponItems.exists(itl.getId())) {
+        range = Data::WeaponItems[itl.getId()].Range;
+    }
+
+    return range;
+}
 
 std::vector<Character *> World::getTargetsInRange(const position &pos, int radius) const {
     Range range;
@@ -651,7 +831,6 @@ void World::checkNPC() {
 
         if (npc->isAlive()) {
             npc->increaseActionPoints(ap);
-            npc->effects.checkEffects();
             std::shared_ptr<LuaNPCScript> npcScript = npc->getScript();
 
             if (npc->canAct() && npcScript) {
@@ -670,6 +849,26 @@ void World::checkNPC() {
 }
 
 
+void World::checkEffects() {
+    effectWheel.advance([this](TYPE_OF_CHARACTER_ID id) {
+        Character *character = findCharacter(id);
+
+        if (!character) {
+            return;
+        }
+
+        // effects of dead monsters and npcs wait, those of players ran regardless before
+        if (character->getType() == Character::player || character->isAlive()) {
+            character->effects.checkEffects();
+        } else {
+            character->effects.delayEffects();
+        }
+    });
+
+    effectWheelEntries.store(effectWheel.size(), std::memory_order_relaxed);
+}
+
+
 void World::workout_CommandBuffer(Player *&cp) {
 }
 
@@ -710,14 +909,71 @@ static std::chrono::steady_clock::time_point getNextIGDayTime() {
 }
 
 void World::initScheduler() {
+    using std::chrono::milliseconds;
+    using std::chrono::steady_clock;
+
+    // player commands are handled in turntheworld and must not wait for the heavy jobs
+    scheduler.setTaskBudget("turntheworld", milliseconds(TURN_BUDGET), TaskPriority::high);
+    scheduler.setTaskBudget("monster_turn", milliseconds(MONSTER_TURN_BUDGET), TaskPriority::normal);
+    scheduler.setTaskBudget("check_scheduled_scripts", milliseconds(SCHEDULED_SCRIPTS_BUDGET), TaskPriority::low);
+    scheduler.setTaskBudget("age_inventory", milliseconds(INVENTORY_AGING_BUDGET), TaskPriority::low);
+    scheduler.setTaskBudget("age_maps", milliseconds(MAP_AGING_BUDGET), TaskPriority::low);
+    scheduler.setTaskBudget("lua_gc", milliseconds(LUA_GC_BUDGET), TaskPriority::low);
+
     scheduler.addRecurringTask([&] { Players.for_each(reduceMC); }, std::chrono::seconds(10), "increase_player_learn_points");
     scheduler.addRecurringTask([&] { Monsters.for_each(reduceMC); Npc.for_each(reduceMC); }, std::chrono::seconds(10), "increase_monster_learn_points");
     scheduler.addRecurringTask([&] { monitoringClientList->CheckClients(); }, std::chrono::milliseconds(250), "check_monitoring_clients");
-    scheduler.addRecurringTask([&] { scheduledScripts->nextCycle(); }, std::chrono::seconds(1), "check_scheduled_scripts");
+    scheduler.addSlicedTask([&](steady_clock::time_point deadline) { return scheduledScripts->nextCycle(deadline); }, std::chrono::seconds(1), milliseconds(100), "check_scheduled_scripts");
     scheduler.addRecurringTask([&] { ageInventory(); }, std::chrono::minutes(3), "age_inventory");
-    scheduler.addRecurringTask([&] { ageMaps(); }, std::chrono::minutes(3), "age_maps");
+    scheduler.addSlicedTask([&](steady_clock::time_point deadline) { return ageMaps(deadline); }, std::chrono::seconds(MAP_AGEING_INTERVAL) / MAP_AGEING_BUCKETS, milliseconds(100), "age_maps");
     scheduler.addRecurringTask([&] { turntheworld(); }, std::chrono::milliseconds(100), "turntheworld");
+    scheduler.addSlicedTask([&](steady_clock::time_point deadline) { return checkMonsters(deadline); }, milliseconds(MIN_AP_UPDATE), milliseconds(MIN_AP_UPDATE), "monster_turn");
     scheduler.addRecurringTask([&] { sendIGTimeToAllPlayers(); }, std::chrono::hours(8), getNextIGDayTime(), "update_ig_day");
+    scheduler.addRecurringTask([&] { reportSchedulerOverruns(); }, std::chrono::minutes(SCHEDULER_REPORT_INTERVAL), "report_scheduler_overruns");
+    scheduler.addRecurringTask([] { Statistic::Statistics::getInstance().saveAsync(); }, std::chrono::minutes(1), "save_statistics");
+
+    const uint16_t gcStepTime = Config::instance().lua_gc_step_time;
+
+    if (gcStepTime > 0) {
+        scheduler.addRecurringTask([gcStepTime] {
+            lua_State *luaState = LuaScript::getLuaState();
+
+            if (luaState) {
+                LuaGarbageCollector::step(luaState, steady_clock::now() + milliseconds(gcStepTime));
+            }
+        }, milliseconds(LUA_GC_STEP_INTERVAL), "lua_gc");
+    }
+
+    auto &statistics = Statistic::Statistics::getInstance();
+    statistics.registerGauge("scheduler_tasks", [this] { return static_cast<double>(scheduler.size()); });
+    statistics.registerGauge("immediate_commands_queue", [this] { return static_cast<double>(immediatePlayerCommands.size()); });
+    statistics.registerGauge("monsters_asleep", [this] { return static_cast<double>(sleepingMonsters.load(std::memory_order_relaxed)); });
+    statistics.registerGauge("ageing_fields", [this] { return static_cast<double>(maps.getAgeingFields()); });
+    statistics.registerGauge("effect_wheel_entries", [this] { return static_cast<double>(effectWheelEntries.load(std::memory_order_relaxed)); });
+}
+
+void World::reportSchedulerOverruns() {
+    using std::chrono::duration_cast;
+    using std::chrono::milliseconds;
+
+    for (const auto &task : scheduler.getTaskStatistics(true)) {
+        if (task.overruns > 0) {
+            Logger::warn(LogFacility::World) << "task " << task.name << " exceeded its budget of "
+                                             << duration_cast<milliseconds>(task.budget).count() << "ms in "
+                                             << task.overruns << " of " << task.runs << " runs, longest run took "
+                                             << duration_cast<milliseconds>(task.longest).count() << "ms" << Log::end;
+        }
+    }
+
+    for (const auto &script : scheduledScripts->getStatistics(true)) {
+        if (script.longest > milliseconds(SCHEDULED_SCRIPTS_BUDGET)) {
+            Logger::warn(LogFacility::World) << "scheduled script " << script.scriptName << "." << script.functionName
+                                             << " ran " << script.runs << " times for "
+                                             << duration_cast<milliseconds>(script.total).count() << "ms, longest run took "
+                                             << duration_cast<milliseconds>(script.longest).count() << "ms, delayed by "
+                                             << script.delayedCycles << " cycles in total" << Log::end;
+        }
+    }
 }
 
 bool World::executeUserCommand(Player *user, const std::string &input, const CommandMap &commands) {
@@ -26,6 +26,7 @@
 #include <sys/timeb.h>
 
 #include <memory>
+#include <atomic>
 #include <list>
 #include <unordered_map>
 #include <regex>
@@ -41,6 +42,10 @@
 #include "MonitoringClients.hpp"
 #include "Scheduler.hpp"
 #include "character_ptr.hpp"
+#include "bounded_queue.hpp"
+#include "tuningConstants.hpp"
+#include "WorkerPool.hpp"
+#include "EffectWheel.hpp"
 
 #include "data/MonsterTable.hpp"
 #include "data/MonsterAttackTable.hpp"
@@ -207,6 +212,9 @@ public:
 
     ClockBasedScheduler<std::chrono::steady_clock> scheduler;
 
+    EffectWheel effectWheel; /**< clock of the long time effects and the characters they are due for */
+    std::atomic<size_t> effectWheelEntries{0}; /**< size of effectWheel after the last turn, for the gauge on the metrics thread */
+
     WeatherStruct weather;/**< a struct to the weather @see WeatherStruct */
 
     /**
@@ -243,14 +251,20 @@ public:
 
     /**
     *checks all actions of the monsters and updates them
+    *works until deadline and returns true once every monster had its turn
     */
-    void checkMonsters();
+    bool checkMonsters(std::chrono::steady_clock::time_point deadline);
 
     /**
     *checks all actions of the NPC's and updates them
     */
     void checkNPC();
 
+    /**
+    *advances the effect clock and runs the long time effects due now
+    */
+    void checkEffects();
+
     /**
     *init method for npc's
     *loads the npc's from the db and sets them on the map
@@ -295,6 +309,10 @@ public:
     static World *create(const std::string &dir);
     static World *get();
 
+    EffectWheel &getEffectWheel() {
+        return effectWheel;
+    }
+
 
     /**============ WorldIMPLTools.cpp ==================*/
 
@@ -331,9 +349,21 @@ public:
     * returns a list of blocking objects between a startin position and a ending position
     * @param startingpos the starting position of the line of sight
     * @param endingpos the end of the line of sight calculation
-    * @return list of all blocking objects between startingpos and endingpos.
+    * @return all blocking objects between startingpos and endingpos, the one closest to endingpos first
     */
-    std::list<BlockingObject> LoS(const position &startingpos, const position &endingpos) const;
+    std::vector<BlockingObject> LoS(const position &startingpos, const position &endingpos) const;
+
+    /**
+    * checks the line of sight, but stops at the first blocking object
+    * @return true if nothing blocks the line between startingpos and endingpos
+    */
+    bool isInSight(const position &startingpos, const position &endingpos) const;
+
+    /**
+    * checks the lines of sight from one position to many targets
+    * @return for every target true if nothing blocks the line to it
+    */
+    std::vector<bool> isInSight(const position &startingpos, const std::vector<position> &targets) const;
 
 
     bool findTargetsInSight(const position &pos, uint8_t range, std::vector<Character *> &ret, Character::face_to direction);
@@ -373,14 +403,6 @@ public:
 
     int getItemAttrib(const std::string &s, TYPE_OF_ITEM_ID ItemID);
 
-    /**
-    *sends all players in sight of the tiles line the map
-    *
-    *@param startx the starting x position of the line
-    *@param endx the ending x position of the line
-    */
-    void updatePlayerView(short int startx, short int endx);
-
     void Load();
     void Save() const;
 
@@ -413,6 +435,13 @@ public:
     */
     void sendAllVisibleCharactersToPlayer(Player *cp, bool sendSpin);
 
+    /**
+    *sends the characters which came into view of a player since it last knew them
+    *and removes those which are out of view now, called after the player moved
+    *@param cp pointer to the player which should recive the data
+    */
+    void sendVisibleCharacterChangesToPlayer(Player *cp);
+
     /**
     *adds a warpfield to a specific groundtile
     *
@@ -503,9 +532,11 @@ public:
     void sendPassiveMoveToAllVisiblePlayers(Character *ccp);
     void sendSpinToAllVisiblePlayers(Character *cc);
     void sendCharacterMoveToAllVisiblePlayers(Character *cc, unsigned char movetype, TYPE_OF_WALKINGCOST duration);
+    // the move is queued and sent with all other moves of this turn by sendPendingMoves
     void sendCharacterMoveToAllVisibleChars(Character *cc, TYPE_OF_WALKINGCOST duration);
     void sendCharacterWarpToAllVisiblePlayers(Character *cc, const position &oldpos, unsigned char netid);
-    template<class T> void sendCharsInVector(const std::vector<T *> &vec, Player *cp, bool sendSpin);
+    template<class T> void sendCharsInVector(const std::vector<T *> &vec, Player *cp, bool sendSpin, bool onlyNew = false);
+    void sendRemoveCharToPlayersOutOfView(Character *cc, const position &from, const position &to);
 
     void lookAtMapItem(Player *player, const position &pos, uint8_t stackPos);
 
@@ -870,6 +901,30 @@ public:
     //\bereich von dem die Spieler genommen werden sollen.
     void sendMapUpdate(const position &pos, uint8_t range);
 
+    /**
+    *remembers that the tile of a field changed, changed fields are sent
+    *to the players viewing them once per turn
+    */
+    void fieldChanged(const position &pos);
+
+    /**
+    *remembers that a map was created, the changed fields do not cover it
+    *so sendMapUpdate resends the full map around it until the end of the turn
+    */
+    void mapCreated(const position &origin, uint16_t width, uint16_t height);
+
+    /**
+    *sends the fields changed since the last call to all players viewing them,
+    *fields lying next to each other are sent as one map stripe
+    */
+    void sendChangedFields();
+
+    /**
+    *sends the moves queued since the last call, every player gets all
+    *moves within its screen together in one write
+    */
+    void sendPendingMoves();
+
     //!Sicherer CreateArea command, prft erst ab ob er eine vorhandene Map berschreibt.
     //\tileid: standard Tile
     //\pos: begin der neuen Karte
@@ -937,10 +992,65 @@ private:
     // check spawns every minute
     Timer monstertimer = {60};
 
+    // monsters of the current monster cycle, see checkMonsters
+    std::vector<TYPE_OF_CHARACTER_ID> monsterCycle;
+    size_t monsterCycleIndex = 0;
+    // actionpoints given to the monsters in the current cycle and gathered for the next one
+    int monsterCycleAP = 0;
+    int pendingMonsterAP = 0;
+
+    // read-only preparation of a monster turn, done in parallel for a batch of monsters
+    // and only trusted as long as the monster did not move in between
+    struct MonsterPlan {
+        Monster *monster = nullptr;
+        bool asleep = false;
+        bool prepared = false;
+        position origin;
+        int targetRadius = 0;
+        std::vector<Character *> targets;
+        bool hasPath = false;
+        position pathGoal;
+        std::list<direction> path;
+    };
+    std::vector<MonsterPlan> monsterPlans;
+    std::unique_ptr<WorkerPool> monsterPlanners;
+    // fields changed in this turn, see fieldChanged
+    std::vector<position> changedFields;
+    // maps created in this turn, see mapCreated
+    struct CreatedMap {
+        position origin;
+        uint16_t width;
+        uint16_t height;
+    };
+    std::vector<CreatedMap> createdMaps;
+
+    // active moves of this turn by character, see sendCharacterMoveToAllVisibleChars
+    struct PendingMove {
+        position pos;
+        TYPE_OF_WALKINGCOST duration;
+    };
+    std::unordered_map<TYPE_OF_CHARACTER_ID, std::vector<PendingMove>> pendingMoves;
+    // immediate position updates make the queued moves of a character obsolete
+    void dropPendingMoves(TYPE_OF_CHARACTER_ID id);
+
+    // monsters skipping their turns for lack of players nearby, counted per cycle
+    // published once per cycle for the gauge sampled on the metrics thread
+    std::atomic<size_t> sleepingMonsters{0};
+    size_t sleepingMonstersInCycle = 0;
+    bool isMonsterAsleep(const Monster &monster) const;
+    void planMonsterTurns(size_t first, size_t count);
+    void planMonsterTurn(MonsterPlan &plan) const;
+    // set by moveTo when a character jumps further than one field, e.g. through a warp or a script,
+    // the remaining plans of the batch are not used then
+    bool monsterPlansStale = false;
+    std::vector<Character *> getPlannedTargets(const MonsterPlan &plan, const Monster &monster, int range) const;
+    static uint16_t getWeaponRange(Monster &monster);
+
     //! das home-Verzeichnis des Servers
     std::string directory;
 
-    void ageMaps();
+    bool ageMaps(std::chrono::steady_clock::time_point deadline);
+    void reportSchedulerOverruns();
     void ageInventory();
 
     //! das Verzeichnis mit den Skripten
@@ -982,6 +1092,9 @@ private:
     // Give help for GM commands
     void gmhelp_command(Player *cp);
 
+    // Control the Lua profiler and list the most expensive entrypoints
+    void luaprofile_command(Player *cp, const std::string &arg);
+
     //Sendet eine Nachricht an alle GM's
     bool gmpage_command(Player *player, const std::string &ticket);
 
@@ -1012,8 +1125,7 @@ private:
 
     void version_command(Player *player);
 
-    std::mutex immediatePlayerCommandsMutex;
-    std::queue<Player*> immediatePlayerCommands;
+    bounded_queue<Player *> immediatePlayerCommands{IMMEDIATE_COMMANDS_QUEUE_SIZE};
     const std::string worldName{"Illarion"};
     const std::regex tilesFilter{".*\\.tiles\\.txt"};
     const std::regex mapFilter{worldName + ".*"};
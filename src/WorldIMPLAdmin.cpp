@@ -20,6 +20,7 @@
 #include "World.hpp"
 
 #include <sstream>
+#include <iomanip>
 #include <list>
 #include <iostream>
 #include <regex>
@@ -48,6 +49,7 @@
 #include "script/LuaLoginScript.hpp"
 #include "script/LuaLogoutScript.hpp"
 #include "script/LuaDepotScript.hpp"
+#include "script/LuaProfiler.hpp"
 
 #include "netinterface/protocol/ServerCommands.hpp"
 #include "netinterface/NetInterface.hpp"
@@ -154,6 +156,9 @@ void World::InitGMCommands() {
 
     GMCommands["spawn"] = [](World *world, Player *player, const std::string &text) -> bool { world->spawn_command(player, text); return true; };
 
+    GMCommands["luaprofile"] = [](World *world, Player *player, const std::string &text) -> bool { world->luaprofile_command(player, text); return true; };
+    GMCommands["lp"] = GMCommands["luaprofile"];
+
 }
 
 void World::spawn_command(Player *cp, const std::string &monid) {
@@ -170,6 +175,61 @@ void World::spawn_command(Player *cp, const std::string &monid) {
     }
 }
 
+void World::luaprofile_command(Player *cp, const std::string &arg) {
+    if (!cp->hasGMRight(gmr_reload)) {
+        return;
+    }
+
+    auto &profiler = LuaProfiler::getInstance();
+
+    if (arg == "on") {
+        profiler.setEnabled(true);
+        cp->inform("Lua profiling enabled.");
+        Logger::info(LogFacility::Admin) << *cp << " enables Lua profiling" << Log::end;
+        return;
+    }
+
+    if (arg == "off") {
+        profiler.setEnabled(false);
+        cp->inform("Lua profiling disabled.");
+        Logger::info(LogFacility::Admin) << *cp << " disables Lua profiling" << Log::end;
+        return;
+    }
+
+    if (arg == "reset") {
+        profiler.reset();
+        cp->inform("Lua profile cleared.");
+        return;
+    }
+
+    size_t count = 10;
+
+    if (!arg.empty()) {
+        try {
+            count = std::stoul(arg);
+        } catch (std::logic_error &) {
+            cp->inform("usage: !luaprofile [on|off|reset|<count>]");
+            return;
+        }
+    }
+
+    if (!profiler.isEnabled()) {
+        cp->inform("Lua profiling is disabled, enable it with !luaprofile on");
+    }
+
+    for (const auto &profile : profiler.getTop(count)) {
+        std::stringstream message;
+        message << std::fixed << std::setprecision(1)
+                << profile.script << ":" << profile.entrypoint
+                << " calls " << profile.time.count
+                << ", total " << profile.time.sum / 1000.0 << "ms"
+                << ", p50 " << profile.time.percentile(0.5) / 1000.0 << "ms"
+                << ", p99 " << profile.time.percentile(0.99) / 1000.0 << "ms"
+                << ", alloc " << profile.allocated / 1024 << "kB";
+        cp->inform(message.str());
+    }
+}
+
 void World::create_command(Player *cp, const std::string &itemid) {
     if (cp->hasGMRight(gmr_basiccommands) || Config::instance().debug) {
         TYPE_OF_ITEM_ID item;
@@ -348,6 +408,7 @@ void World::makeVisible(Player *cp) {
 
     for (const auto &player : Players.findAllCharactersInScreen(cp->getPosition())) {
         if (cp != player) {
+            player->learnChar(cp->getId());
             ServerCommandPointer cmd = std::make_shared<MoveAckTC>(cp->getId(), cp->getPosition(), PUSH, 0);
             player->Connection->addCommand(cmd);
         }
@@ -410,7 +471,7 @@ void World::forceLogoutOfAllPlayers() {
         sendMonitoringMessage(message);
         ServerCommandPointer cmd = std::make_shared<LogOutTC>(SERVERSHUTDOWN);
         player->Connection->shutdownSend(cmd);
-        PlayerManager::get().getLogOutPlayers().push_back(player);
+        PlayerManager::get().logoutPlayer(player);
     });
 
     Players.clear();
@@ -630,13 +691,10 @@ void World::setNextTile(Player *cp, unsigned char tilenumber) {
     try {
         Field &field = fieldAt(pos);
         field.setTileId(tilenumber);
+        fieldChanged(pos);
     } catch (FieldNotFound &) {
     }
 
-    //update the current area
-    cp->sendRelativeArea(0);
-    sendAllVisibleCharactersToPlayer(cp, true);
-
 }
 
 
@@ -887,6 +945,8 @@ void World::gmhelp_command(Player *cp) {
         cp->inform(tmessage);
         tmessage = "!fullreload - (!fr) reloads all database tables";
         cp->inform(tmessage);
+        tmessage = "!luaprofile [on|off|reset|<count>] - (!lp) controls the Lua profiler or lists the <count> most expensive script entrypoints.";
+        cp->inform(tmessage);
     }
 
     if (cp->hasGMRight(gmr_import)) {
@@ -1146,6 +1206,7 @@ void create_area_command(World *world, Player *player,const std::string &params)
 
     if (world->maps.createMap("by " + player->to_string(), position(x, y, z), w,
                               h, tile)) {
+        world->mapCreated(position(x, y, z), w, h);
         std::string tmessage = "Map inserted.";
         player->inform(tmessage);
         Logger::info(LogFacility::World) << "Map created by " << *player
@@ -17,11 +17,15 @@
 //  along with illarionserver.  If not, see <http://www.gnu.org/licenses/>.
 
 
+#include <algorithm>
+#include <cstdlib>
+
 #include "Field.hpp"
 #include "Logger.hpp"
 #include "Monster.hpp"
 #include "NPC.hpp"
 #include "Player.hpp"
+#include "Statistics.hpp"
 #include "World.hpp"
 #include "data/Data.hpp"
 #include "netinterface/BasicServerCommand.hpp"
@@ -79,17 +83,46 @@ void World::TriggerFieldMove(Character *cc, bool moveto) {
 }
 
 void World::moveTo(Character *cc, const position& to) {
+    const position from = cc->getPosition();
+    bool inWorld = false;
+
     switch(cc->getType()) {
         case Character::player:
-            Players.update(dynamic_cast<Player *>(cc), to);
+            inWorld = Players.update(dynamic_cast<Player *>(cc), to);
             break;
         case Character::monster:
-            Monsters.update(dynamic_cast<Monster *>(cc), to);
+            inWorld = Monsters.update(dynamic_cast<Monster *>(cc), to);
             break;
         case Character::npc:
-            Npc.update(dynamic_cast<NPC *>(cc), to);
+            inWorld = Npc.update(dynamic_cast<NPC *>(cc), to);
             break;
     }
+
+    // characters still being built, e.g. players on the login threads, are not known to anyone
+    if (inWorld && !(from == to)) {
+        sendRemoveCharToPlayersOutOfView(cc, from, to);
+
+        if (abs(to.x - from.x) > 1 || abs(to.y - from.y) > 1 || to.z != from.z) {
+            monsterPlansStale = true;
+        }
+    }
+}
+
+
+void World::sendRemoveCharToPlayersOutOfView(Character *cc, const position &from, const position &to) {
+    Range range;
+    range.radius = MAX_SCREEN_RANGE;
+    ServerCommandPointer cmd;
+
+    for (const auto &player : Players.findAllCharactersInRangeOf(from, range)) {
+        if (!player->isInScreen(to) && player->forgetChar(cc->getId())) {
+            if (!cmd) {
+                cmd = std::make_shared<RemoveCharTC>(cc->getId());
+            }
+
+            player->Connection->addCommand(cmd);
+        }
+    }
 }
 
 
@@ -102,6 +135,7 @@ void World::sendSpinToAllVisiblePlayers(Character *cc) {
 
 
 void World::sendPassiveMoveToAllVisiblePlayers(Character *ccp) {
+    dropPendingMoves(ccp->getId());
     char xoffs;
     char yoffs;
     char zoffs;
@@ -114,6 +148,7 @@ void World::sendPassiveMoveToAllVisiblePlayers(Character *ccp) {
         zoffs = charPos.z - playerPos.z + RANGEDOWN;
 
         if ((xoffs != 0) || (yoffs != 0) || (zoffs != RANGEDOWN)) {
+            p->learnChar(ccp->getId());
             ServerCommandPointer cmd = std::make_shared<MoveAckTC>(ccp->getId(), charPos, PUSH, 0);
             p->Connection->addCommand(cmd);
         }
@@ -124,10 +159,109 @@ void World::sendPassiveMoveToAllVisiblePlayers(Character *ccp) {
 
 void World::sendCharacterMoveToAllVisibleChars(Character *cc, TYPE_OF_WALKINGCOST duration) {
     // for now we only send events to players... TODO change this whole command
-    sendCharacterMoveToAllVisiblePlayers(cc, NORMALMOVE, duration);
+    if (!cc->isInvisible()) {
+        PendingMove move;
+        move.pos = cc->getPosition();
+        move.duration = duration;
+        pendingMoves[cc->getId()].push_back(move);
+    }
+}
+
+void World::dropPendingMoves(TYPE_OF_CHARACTER_ID id) {
+    pendingMoves.erase(id);
+}
+
+void World::sendPendingMoves() {
+    if (pendingMoves.empty()) {
+        return;
+    }
+
+    struct QueuedMove {
+        TYPE_OF_CHARACTER_ID id;
+        const Character *character;
+        position pos;
+        TYPE_OF_WALKINGCOST duration;
+    };
+
+    // the moves of one character follow each other in the order they were made
+    std::vector<QueuedMove> moves;
+
+    for (const auto &characterMoves : pendingMoves) {
+        const auto character = findCharacter(characterMoves.first);
+
+        // characters might have died or vanished since they moved
+        if (!character || character->isInvisible()) {
+            continue;
+        }
+
+        for (const auto &move : characterMoves.second) {
+            moves.push_back({characterMoves.first, character, move.pos, move.duration});
+        }
+    }
+
+    pendingMoves.clear();
+
+    // the moves sorted by x are joined with all players at once instead of searching the screen of every move
+    std::vector<size_t> byX(moves.size());
+
+    for (size_t i = 0; i < byX.size(); ++i) {
+        byX[i] = i;
+    }
+
+    std::sort(byX.begin(), byX.end(), [&moves](size_t a, size_t b) {
+        return moves[a].pos.x < moves[b].pos.x;
+    });
+
+    std::vector<ServerCommandPointer> commands(moves.size());
+    std::vector<size_t> seen;
+    std::vector<ServerCommandPointer> batch;
+
+    Players.for_each([&](Player *player) {
+        const auto &playerPos = player->getPosition();
+        seen.clear();
+
+        auto first = std::lower_bound(byX.begin(), byX.end(), playerPos.x - MAX_SCREEN_RANGE, [&moves](size_t i, int x) {
+            return moves[i].pos.x < x;
+        });
+
+        for (auto it = first; it != byX.end() && moves[*it].pos.x <= playerPos.x + MAX_SCREEN_RANGE; ++it) {
+            const auto &move = moves[*it];
+
+            // players which cannot see the character any more were told to remove it by moveTo
+            if (move.id != player->getId() && !(move.pos == playerPos) && player->isInScreen(move.pos)
+                && player->isInScreen(move.character->getPosition())) {
+                seen.push_back(*it);
+            }
+        }
+
+        if (seen.empty()) {
+            return;
+        }
+
+        std::sort(seen.begin(), seen.end());
+        batch.clear();
+
+        for (const auto i : seen) {
+            const auto &move = moves[i];
+            player->learnChar(move.id);
+
+            if (!commands[i]) {
+                commands[i] = std::make_shared<MoveAckTC>(move.id, move.pos, NORMALMOVE, move.duration);
+            }
+
+            batch.push_back(commands[i]);
+        }
+
+        player->Connection->addCommands(batch);
+    });
+
+    static const auto movesSent = Statistic::Statistics::getInstance().registerCounter("character_moves_batched");
+    Statistic::Statistics::getInstance().increment(movesSent, moves.size());
 }
 
 void World::sendCharacterMoveToAllVisiblePlayers(Character *cc, unsigned char netid, TYPE_OF_WALKINGCOST duration) {
+    dropPendingMoves(cc->getId());
+
     if (!cc->isInvisible()) {
         char xoffs;
         char yoffs;
@@ -141,6 +275,7 @@ void World::sendCharacterMoveToAllVisiblePlayers(Character *cc, unsigned char ne
             zoffs = charPos.z - playerPos.z + RANGEDOWN;
 
             if ((xoffs != 0) || (yoffs != 0) || (zoffs != RANGEDOWN)) {
+                p->learnChar(cc->getId());
                 ServerCommandPointer cmd = std::make_shared<MoveAckTC>(cc->getId(), charPos, netid, duration);
                 p->Connection->addCommand(cmd);
             }
@@ -150,19 +285,13 @@ void World::sendCharacterMoveToAllVisiblePlayers(Character *cc, unsigned char ne
 
 
 void World::sendCharacterWarpToAllVisiblePlayers(Character *cc, const position &oldpos, unsigned char netid) {
-    if (!cc->isInvisible()) {
-        {
-            ServerCommandPointer cmd = std::make_shared<RemoveCharTC>(cc->getId());
-
-            for (const auto &player : Players.findAllCharactersInScreen(oldpos)) {
-                if (!player->isInScreen(cc->getPosition())) {
-                    player->sendCharRemove(cc->getId(), cmd);
-                }
-            }
-        }
+    dropPendingMoves(cc->getId());
 
+    if (!cc->isInvisible()) {
+        // players which cannot see the new position were already told to remove cc by moveTo
         for (const auto &p : Players.findAllCharactersInScreen(cc->getPosition())) {
             if (cc != p) {
+                p->learnChar(cc->getId());
                 ServerCommandPointer cmd = std::make_shared<MoveAckTC>(cc->getId(), cc->getPosition(), PUSH, 0);
                 p->Connection->addCommand(cmd);
             }
@@ -188,21 +317,53 @@ void World::sendAllVisibleCharactersToPlayer(Player *cp, bool sendSpin) {
 }
 
 
+void World::sendVisibleCharacterChangesToPlayer(Player *cp) {
+    std::vector<TYPE_OF_CHARACTER_ID> outOfView;
+
+    for (const auto id : cp->getVisibleChars()) {
+        const auto character = findCharacter(id);
+
+        if (!character || !cp->isInScreen(character->getPosition())) {
+            outOfView.push_back(id);
+        }
+    }
+
+    for (const auto id : outOfView) {
+        ServerCommandPointer cmd = std::make_shared<RemoveCharTC>(id);
+        cp->sendCharRemove(id, cmd);
+    }
+
+    Range range;
+    range.radius = cp->getScreenRange();
+
+    sendCharsInVector(Players.findAllCharactersInRangeOf(cp->getPosition(), range), cp, true, true);
+    sendCharsInVector(Monsters.findAllCharactersInRangeOf(cp->getPosition(), range), cp, true, true);
+    sendCharsInVector(Npc.findAllCharactersInRangeOf(cp->getPosition(), range), cp, true, true);
+
+    cp->sendAvailableQuests();
+}
+
+
 template<class T>
-void World::sendCharsInVector(const std::vector<T *> &vec, Player *cp, bool sendSpin) {
+void World::sendCharsInVector(const std::vector<T *> &vec, Player *cp, bool sendSpin, bool onlyNew) {
     char xoffs;
     char yoffs;
     char zoffs;
     const auto &playerPos = cp->getPosition();
 
     for (const auto &cc : vec) {
-        if (!cc->isInvisible()) {
+        // players only get moves of characters on their screen, see findAllCharactersInScreen
+        if (!cc->isInvisible() && cp->isInScreen(cc->getPosition())) {
             const auto &charPos = cc->getPosition();
             xoffs = charPos.x - playerPos.x;
             yoffs = charPos.y - playerPos.y;
             zoffs = charPos.z - playerPos.z + RANGEDOWN;
 
             if ((xoffs != 0) || (yoffs != 0) || (zoffs != RANGEDOWN)) {
+                if (!cp->learnChar(cc->getId()) && onlyNew) {
+                    continue;
+                }
+
                 ServerCommandPointer cmd = std::make_shared<MoveAckTC>(cc->getId(), charPos, PUSH, 0);
                 cp->Connection->addCommand(cmd);
                 cmd = std::make_shared<PlayerSpinTC>(cc->getFaceTo(), cc->getId());
@@ -222,6 +383,7 @@ bool World::addWarpField(const position &where, const position &target, unsigned
 
         if (starttilenr != 0) {
             field.setTileId(starttilenr);
+            fieldChanged(where);
         }
 
         if (startitemnr != 0) {
@@ -555,6 +555,7 @@ bool World::putItemOnMap(Character *cc, const position &itemPosition) {
                 }
 
                 checkField(field, itemPosition);
+                maps.registerAgeing(itemPosition);
                 g_item.reset();
                 g_cont = nullptr;
 
@@ -576,6 +577,7 @@ bool World::putItemOnMap(Character *cc, const position &itemPosition) {
                 }
 
                 checkField(field, itemPosition);
+                maps.registerAgeing(itemPosition);
                 g_cont = nullptr;
                 g_item.reset();
 
@@ -614,6 +616,7 @@ bool World::putItemAlwaysOnMap(Character *cc, const position &itemPosition) {
                 }
 
                 checkField(field, itemPosition);
+                maps.registerAgeing(itemPosition);
                 g_item.reset();
                 g_cont = nullptr;
 
@@ -636,6 +639,7 @@ bool World::putItemAlwaysOnMap(Character *cc, const position &itemPosition) {
                 }
 
                 checkField(field, itemPosition);
+                maps.registerAgeing(itemPosition);
                 g_cont = nullptr;
                 g_item.reset();
 
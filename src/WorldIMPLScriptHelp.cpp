@@ -17,6 +17,10 @@
 //  along with illarionserver.  If not, see <http://www.gnu.org/licenses/>.
 
 
+#include <algorithm>
+#include <cstdlib>
+#include <tuple>
+
 #include "character_ptr.hpp"
 #include "Field.hpp"
 #include "Item.hpp"
@@ -26,6 +30,7 @@
 #include "Monster.hpp"
 #include "NPC.hpp"
 #include "Player.hpp"
+#include "Statistics.hpp"
 #include "World.hpp"
 
 #include "data/Data.hpp"
@@ -179,6 +184,7 @@ bool World::changeItem(ScriptItem item) {
 
             if (field.takeItemFromStack(it)) {
                 field.addItemOnStack(static_cast<Item>(item));
+                maps.registerAgeing(item.pos);
 
                 if (item.getId() != it.getId() || it.getNumber() != item.getNumber()) {
                     sendSwapItemOnMapToAllVisibleCharacter(it.getId(), item.pos, item);
@@ -202,9 +208,9 @@ bool World::changeItem(ScriptItem item) {
 
 std::string World::getItemName(TYPE_OF_ITEM_ID itemid, uint8_t language) {
     if (language == 0) {
-        return Data::Items[itemid].German;
+        return Data::Items.names(itemid).German;
     } else {
-        return Data::Items[itemid].English;
+        return Data::Items.names(itemid).English;
     }
 }
 
@@ -322,6 +328,7 @@ bool World::swap(ScriptItem item, TYPE_OF_ITEM_ID newitem, unsigned short int ne
             if (field.viewItemOnStack(it)) {
 
                 if (field.swapItemOnStack(newitem, newQuality)) {
+                    maps.registerAgeing(item.pos);
                     Item dummy;
                     dummy.setId(newitem);
                     dummy.setNumber(it.getNumber());
@@ -463,6 +470,7 @@ void World::changeTile(short int tileid, const position &pos) {
     try {
         Field &field = fieldAt(pos);
         field.setTileId(tileid);
+        fieldChanged(pos);
     } catch (FieldNotFound &) {
         logMissingField("changeTile", pos);
     }
@@ -470,6 +478,24 @@ void World::changeTile(short int tileid, const position &pos) {
 
 
 void World::sendMapUpdate(const position &pos, uint8_t radius) {
+    const auto inRadius = [&pos, radius](const position &changed) {
+        return abs(changed.x - pos.x) <= radius && abs(changed.y - pos.y) <= radius
+               && abs(changed.z - pos.z) <= RANGEUP;
+    };
+
+    const auto overlapsRadius = [&pos, radius](const CreatedMap &map) {
+        return map.origin.x <= pos.x + radius && pos.x - radius < map.origin.x + map.width
+               && map.origin.y <= pos.y + radius && pos.y - radius < map.origin.y + map.height
+               && abs(map.origin.z - pos.z) <= RANGEUP;
+    };
+
+    // fields changed through changeTile are sent at the end of the turn anyway,
+    // the full map is only needed for other changes, e.g. created maps
+    if (std::none_of(createdMaps.begin(), createdMaps.end(), overlapsRadius)
+        && std::any_of(changedFields.begin(), changedFields.end(), inRadius)) {
+        return;
+    }
+
     Range range;
     range.radius = radius;
     auto playersInRange = Players.findAllCharactersInRangeOf(pos, range);
@@ -480,9 +506,85 @@ void World::sendMapUpdate(const position &pos, uint8_t radius) {
     }
 }
 
+
+void World::fieldChanged(const position &pos) {
+    changedFields.push_back(pos);
+}
+
+
+void World::mapCreated(const position &origin, uint16_t width, uint16_t height) {
+    createdMaps.push_back({origin, width, height});
+}
+
+
+void World::sendChangedFields() {
+    createdMaps.clear();
+
+    if (changedFields.empty()) {
+        return;
+    }
+
+    // fields on a map stripe going right share z and x - y and follow each other in x
+    std::sort(changedFields.begin(), changedFields.end(), [](const position &a, const position &b) {
+        return std::make_tuple(a.z, a.x - a.y, a.x) < std::make_tuple(b.z, b.x - b.y, b.x);
+    });
+    changedFields.erase(std::unique(changedFields.begin(), changedFields.end()), changedFields.end());
+
+    static const auto fieldsSent = Statistic::Statistics::getInstance().registerCounter("map_fields_updated");
+    std::vector<const Field *> stripe;
+    size_t first = 0;
+
+    while (first < changedFields.size()) {
+        const position &start = changedFields[first];
+        size_t last = first;
+
+        while (last + 1 < changedFields.size() && last + 1 - first < MAX_CHANGED_FIELDS_STRIPE) {
+            const position &next = changedFields[last + 1];
+            const position &previous = changedFields[last];
+
+            if (next.z != previous.z || next.x != previous.x + 1 || next.y != previous.y + 1) {
+                break;
+            }
+
+            ++last;
+        }
+
+        stripe.clear();
+
+        for (size_t i = first; i <= last; ++i) {
+            try {
+                stripe.push_back(&fieldAt(changedFields[i]));
+            } catch (FieldNotFound &) {
+                stripe.push_back(nullptr);
+            }
+        }
+
+        const position &end = changedFields[last];
+        Range range;
+        range.radius = MAX_FIELD_VIEW_RANGE + static_cast<int>(last - first);
+        ServerCommandPointer cmd;
+
+        for (const auto &player : Players.findAllCharactersInRangeOf(start, range)) {
+            if (player->isFieldInView(start) || player->isFieldInView(end)) {
+                if (!cmd) {
+                    cmd = std::make_shared<MapStripeTC>(start, NewClientView::dir_right, stripe);
+                }
+
+                player->Connection->addCommand(cmd);
+            }
+        }
+
+        Statistic::Statistics::getInstance().increment(fieldsSent, last - first + 1);
+        first = last + 1;
+    }
+
+    changedFields.clear();
+}
+
 bool World::createSavedArea(uint16_t tile, const position &origin,
                             uint16_t height, uint16_t width) {
     if (maps.createMap("by createSavedArea", origin, width, height, tile)) {
+        mapCreated(origin, width, height);
         Logger::info(LogFacility::World)
             << "Map created by createSavedArea command at " << origin
             << " height: " << height << " width: " << width
@@ -26,6 +26,7 @@
 #include "Field.hpp"
 #include "netinterface/protocol/ServerCommands.hpp"
 #include "Logger.hpp"
+#include "MessageGarbler.hpp"
 #include "data/Data.hpp"
 
 void World::sendMessageToAdmin(const std::string &message) {
@@ -154,10 +155,13 @@ void World::sendMessageToAllCharsInRange(const std::string &german, const std::s
     // tell all OTHER players... (but tell them what they understand due to their inability to do so)
     // tell the player himself what he wanted to say
     std::string prefix = languagePrefix(cc->getActiveLanguage());
+    MessageGarbler germanListeners(spokenMessage_german);
+    MessageGarbler englishListeners(spokenMessage_english);
 
     for (const auto &player : Players.findAllCharactersInRangeOf(cc->getPosition(), range)) {
         if (!is_action && player->getId() != cc->getId()) {
-            tempMessage = prefix + player->alterSpokenMessage(player->nls(spokenMessage_german, spokenMessage_english), player->getLanguageSkill(cc->getActiveLanguage()));
+            auto &listeners = player->getPlayerLanguage() == Language::german ? germanListeners : englishListeners;
+            tempMessage.assign(prefix).append(listeners.forSkill(player->getLanguageSkill(cc->getActiveLanguage())));
             player->receiveText(tt, tempMessage, cc);
         } else {
             if (is_action) {
@@ -169,9 +173,11 @@ void World::sendMessageToAllCharsInRange(const std::string &german, const std::s
     }
 
     if (cc->getType() == Character::player) {
+        MessageGarbler npcListeners(english);
+
         // tell all npcs
         for (const auto &npc : Npc.findAllCharactersInRangeOf(cc->getPosition(), range)) {
-            tempMessage=prefix + npc->alterSpokenMessage(english, npc->getLanguageSkill(cc->getActiveLanguage()));
+            tempMessage.assign(prefix).append(npcListeners.forSkill(npc->getLanguageSkill(cc->getActiveLanguage())));
             npc->receiveText(tt, tempMessage, cc);
         }
 
@@ -195,6 +201,8 @@ void World::sendLanguageMessageToAllCharsInRange(const std::string &message, Cha
     // alter message because of the speakers inability to speak...
     std::string spokenMessage,tempMessage;
     spokenMessage=cc->alterSpokenMessage(message,cc->getLanguageSkill(cc->getActiveLanguage()));
+    const std::string prefix = languagePrefix(cc->getActiveLanguage());
+    MessageGarbler listeners(spokenMessage);
 
     // tell all OTHER players... (but tell them what they understand due to their inability to do so)
     // tell the player himself what he wanted to say
@@ -208,10 +216,10 @@ void World::sendLanguageMessageToAllCharsInRange(const std::string &message, Cha
         for (const auto &player : players) {
             if (player->getPlayerLanguage() == lang) {
                 if (player->getId() != cc->getId()) {
-                    tempMessage=languagePrefix(cc->getActiveLanguage()) + player->alterSpokenMessage(spokenMessage, player->getLanguageSkill(cc->getActiveLanguage()));
+                    tempMessage.assign(prefix).append(listeners.forSkill(player->getLanguageSkill(cc->getActiveLanguage())));
                     player->receiveText(tt, tempMessage, cc);
                 } else {
-                    player->receiveText(tt, languagePrefix(cc->getActiveLanguage())+message, cc);
+                    player->receiveText(tt, prefix + message, cc);
                 }
             }
         }
@@ -220,7 +228,7 @@ void World::sendLanguageMessageToAllCharsInRange(const std::string &message, Cha
     if (cc->getType() == Character::player) {
         // tell all npcs
         for (const auto &npc : npcs) {
-            tempMessage=languagePrefix(cc->getActiveLanguage()) + npc->alterSpokenMessage(spokenMessage, npc->getLanguageSkill(cc->getActiveLanguage()));
+            tempMessage.assign(prefix).append(listeners.forSkill(npc->getLanguageSkill(cc->getActiveLanguage())));
             npc->receiveText(tt, tempMessage, cc);
         }
 
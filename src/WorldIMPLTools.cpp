@@ -20,6 +20,7 @@
 
 #include "World.hpp"
 
+#include <algorithm>
 #include <list>
 #include <stdlib.h>
 
@@ -68,6 +69,8 @@ void World::deleteAllLostNPC() {
 
 bool World::findTargetsInSight(const position &pos, uint8_t range, std::vector<Character *> &ret, Character::face_to direction) {
     bool found = false;
+    std::vector<Character *> candidates;
+    std::vector<position> candidatePositions;
 
     for (const auto &candidate : getTargetsInRange(pos, range)) {
         bool indir = false;
@@ -144,21 +147,30 @@ bool World::findTargetsInSight(const position &pos, uint8_t range, std::vector<C
         }
 
         if (indir) {
-            std::list<BlockingObject> objects = LoS(pos, candidate->getPosition());
+            candidates.push_back(candidate);
+            candidatePositions.push_back(candidatePos);
+        }
+    }
 
-            if (objects.empty()) {
-                ret.push_back(candidate);
-                found = true;
-            }
+    const auto visible = isInSight(pos, candidatePositions);
+
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (visible[i]) {
+            ret.push_back(candidates[i]);
+            found = true;
         }
     }
 
     return found;
 }
 
-std::list<BlockingObject> World::LoS(const position &startingpos, const position &endingpos) const {
-    std::list<BlockingObject> ret;
-    ret.clear();
+namespace {
+
+// visits the fields between startingpos and endingpos with Bresenham's algorithm, always in
+// ascending order of the main axis, until visit returns false
+// returns true if the line is walked from endingpos towards startingpos
+template<class Visitor>
+bool traceLine(const position &startingpos, const position &endingpos, Visitor visit) {
     bool steep = std::abs(startingpos.y - endingpos.y) > std::abs(startingpos.x - endingpos.x);
     short int startx=startingpos.x;
     short int starty=startingpos.y;
@@ -167,26 +179,15 @@ std::list<BlockingObject> World::LoS(const position &startingpos, const position
 
     if (steep) {
         //change x,y values for correct algorithm in negativ range
-        short int change;
-        change = startx;
-        startx = starty;
-        starty = change;
-        change = endx;
-        endx = endy;
-        endy = change;
+        std::swap(startx, starty);
+        std::swap(endx, endy);
     }
 
     bool swapped = startx > endx;
 
     if (swapped) {
-        short int change;
-        change = startx;
-        startx = endx;
-        endx = change;
-        change = starty;
-        starty = endy;
-        endy = change;
-
+        std::swap(startx, endx);
+        std::swap(starty, endy);
     }
 
     short int deltax = endx - startx;
@@ -201,7 +202,6 @@ std::list<BlockingObject> World::LoS(const position &startingpos, const position
 
     for (short int x = startx; x <= endx; ++x) {
         if (!(x == startx && y == starty) && !(x == endx && y == endy)) {
-            BlockingObject bo;
             position pos{x, y, startingpos.z};
 
             if (steep) {
@@ -209,43 +209,8 @@ std::list<BlockingObject> World::LoS(const position &startingpos, const position
                 pos.y = x;
             }
 
-            try {
-                const Field &field = fieldAt(pos);
-                
-                if (field.hasPlayer()) {
-                    bo.blockingType = BlockingObject::BT_CHARACTER;
-                    bo.blockingChar = findCharacterOnField(pos);
-
-                    if (swapped) {
-                        ret.push_back(bo);
-                    } else {
-                        ret.push_front(bo);
-                    }
-                } else {
-                    ScriptItem it;
-
-                    for (size_t i = 0; i < field.itemCount(); ++i) {
-                        auto testItem = field.getStackItem(i);
-                        
-                        if (testItem.getVolume() > it.getVolume()) {
-                            it = testItem;
-                        }
-                    }
-                        
-                    if (it.isLarge()) {
-                        bo.blockingType = BlockingObject::BT_ITEM;
-                        it.pos = pos;
-                        it.type = ScriptItem::it_field;
-                        bo.blockingItem = it;
-
-                        if (swapped) {
-                            ret.push_back(bo);
-                        } else {
-                            ret.push_front(bo);
-                        }
-                    }
-                }
-            } catch (FieldNotFound &) {
+            if (!visit(pos)) {
+                break;
             }
         }
 
@@ -257,9 +222,123 @@ std::list<BlockingObject> World::LoS(const position &startingpos, const position
         }
     }
 
+    return swapped;
+}
+
+}
+
+std::vector<BlockingObject> World::LoS(const position &startingpos, const position &endingpos) const {
+    std::vector<BlockingObject> ret;
+
+    bool fromEnd = traceLine(startingpos, endingpos, [this, &ret](const position &pos) {
+        try {
+            const Field &field = fieldAt(pos);
+
+            if (field.hasPlayer()) {
+                BlockingObject bo;
+                bo.blockingType = BlockingObject::BT_CHARACTER;
+                bo.blockingChar = findCharacterOnField(pos);
+                ret.push_back(bo);
+            } else if (field.hasViewBlockingItem()) {
+                BlockingObject bo;
+                bo.blockingType = BlockingObject::BT_ITEM;
+                bo.blockingItem = field.getViewBlockingItem();
+                bo.blockingItem.pos = pos;
+                ret.push_back(bo);
+            }
+        } catch (FieldNotFound &) {
+        }
+
+        return true;
+    });
+
+    // objects closest to endingpos come first
+    if (!fromEnd) {
+        std::reverse(ret.begin(), ret.end());
+    }
+
     return ret;
 }
 
+bool World::isInSight(const position &startingpos, const position &endingpos) const {
+    bool visible = true;
+
+    traceLine(startingpos, endingpos, [this, &visible](const position &pos) {
+        try {
+            const Field &field = fieldAt(pos);
+            visible = !field.hasPlayer() && !field.hasViewBlockingItem();
+        } catch (FieldNotFound &) {
+        }
+
+        return visible;
+    });
+
+    return visible;
+}
+
+std::vector<bool> World::isInSight(const position &startingpos, const std::vector<position> &targets) const {
+    std::vector<bool> visible(targets.size(), true);
+
+    if (targets.empty()) {
+        return visible;
+    }
+
+    short int minx = startingpos.x;
+    short int maxx = startingpos.x;
+    short int miny = startingpos.y;
+    short int maxy = startingpos.y;
+
+    for (const auto &target : targets) {
+        minx = std::min(minx, target.x);
+        maxx = std::max(maxx, target.x);
+        miny = std::min(miny, target.y);
+        maxy = std::max(maxy, target.y);
+    }
+
+    const size_t width = maxx - minx + 1;
+    const size_t height = maxy - miny + 1;
+
+    if (width * height > MAX_SIGHT_BATCH_AREA) {
+        for (size_t i = 0; i < targets.size(); ++i) {
+            visible[i] = isInSight(startingpos, targets[i]);
+        }
+
+        return visible;
+    }
+
+    // the lines share the fields close to startingpos, so every field is looked up only once
+    enum : uint8_t { fieldUnknown, fieldFree, fieldBlocked };
+    std::vector<uint8_t> fields(width * height, fieldUnknown);
+
+    for (size_t i = 0; i < targets.size(); ++i) {
+        bool targetVisible = true;
+
+        traceLine(startingpos, targets[i], [&](const position &pos) {
+            auto &state = fields[(pos.y - miny) * width + (pos.x - minx)];
+
+            if (state == fieldUnknown) {
+                state = fieldFree;
+
+                try {
+                    const Field &field = fieldAt(pos);
+
+                    if (field.hasPlayer() || field.hasViewBlockingItem()) {
+                        state = fieldBlocked;
+                    }
+                } catch (FieldNotFound &) {
+                }
+            }
+
+            targetVisible = state == fieldFree;
+            return targetVisible;
+        });
+
+        visible[i] = targetVisible;
+    }
+
+    return visible;
+}
+
 //function which updates the playerlist.
 void World::updatePlayerList() {
     using namespace Database;
@@ -606,23 +685,13 @@ int World::getItemAttrib(const std::string &s, TYPE_OF_ITEM_ID ItemID) {
 }
 
 
-void World::updatePlayerView(short int startx, short int endx) {
-    std::vector<Player *> temp;
-
-    if (Players.findAllCharactersWithXInRangeOf(startx - 20, endx + 20, temp)) {
-        for (const auto &player : temp) {
-            player->sendFullMap();
-            sendAllVisibleCharactersToPlayer(player, true);
+bool World::ageMaps(std::chrono::steady_clock::time_point deadline) {
+    return maps.ageingBucketDone(deadline, [this](const position &pos, const Field &field) {
+        for (const auto &player : Players.findAllCharactersInScreen(pos)) {
+            ServerCommandPointer cmd = std::make_shared<ItemUpdate_TC>(pos, field.getItemStack());
+            player->Connection->addCommand(cmd);
         }
-    }
-
-}
-
-
-void World::ageMaps() {
-    if (not maps.allMapsAged()) {
-        scheduler.addOneshotTask([&] { ageMaps(); }, std::chrono::seconds(1), "age_maps");
-    }
+    });
 }
 
 
@@ -31,6 +31,14 @@
 void WorldMap::clear() {
     world_map.clear();
     maps.clear();
+    ageingFields.clear();
+    ageingFieldCount.store(0, std::memory_order_relaxed);
+
+    for (auto &bucket : ageingBuckets) {
+        bucket.clear();
+    }
+
+    ageingIndex = 0;
 }
 
 bool WorldMap::intersects(const Map &map) const {
@@ -92,28 +100,66 @@ bool WorldMap::insert(Map&& newMap) {
         for (auto y = map.getMinY(); y <= map.getMaxY(); ++y) {
             position p(x, y, z);
             world_map[p] = maps.size() - 1;
+
+            if (map.at(x, y).isAgeing()) {
+                registerAgeing(p);
+            }
         }
     }
 
     return true;
 }
 
-bool WorldMap::allMapsAged() {
+void WorldMap::registerAgeing(const position &pos) {
+    if (ageingFields.insert(pos).second) {
+        ageingBuckets[nextAgeingBucket].push_back(pos);
+        nextAgeingBucket = (nextAgeingBucket + 1) % ageingBuckets.size();
+        ageingFieldCount.store(ageingFields.size(), std::memory_order_relaxed);
+    }
+}
+
+size_t WorldMap::getAgeingFields() const {
+    return ageingFieldCount.load(std::memory_order_relaxed);
+}
+
+bool WorldMap::ageingBucketDone(std::chrono::steady_clock::time_point deadline, const rotted_function &rotted) {
     using std::chrono::steady_clock;
-    using std::chrono::milliseconds;
 
-    auto startTime = steady_clock::now();
+    auto &bucket = ageingBuckets[ageingBucket];
+    bool first = true;
 
-    while (ageIndex < maps.size() &&
-           steady_clock::now() - startTime < milliseconds(10)) {
-        maps[ageIndex++].age();
-    }
+    while (ageingIndex < bucket.size()) {
+        // every call makes progress, even if the deadline already passed
+        if (!first && steady_clock::now() >= deadline) {
+            return false;
+        }
 
-    if (ageIndex < maps.size()) {
-        return false;
+        first = false;
+        const position pos = bucket[ageingIndex];
+
+        try {
+            Field &field = at(pos);
+
+            if (field.age() != 0) {
+                rotted(pos, field);
+            }
+
+            if (field.isAgeing()) {
+                ++ageingIndex;
+                continue;
+            }
+        } catch (FieldNotFound &) {
+        }
+
+        // nothing left that could rot, the field is registered again once items are put on it
+        ageingFields.erase(pos);
+        ageingFieldCount.store(ageingFields.size(), std::memory_order_relaxed);
+        bucket[ageingIndex] = bucket.back();
+        bucket.pop_back();
     }
 
-    ageIndex = 0;
+    ageingIndex = 0;
+    ageingBucket = (ageingBucket + 1) % ageingBuckets.size();
     return true;
 }
 
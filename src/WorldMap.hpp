@@ -20,17 +20,30 @@
 #ifndef _WORLDMAP_HPP_
 #define _WORLDMAP_HPP_
 
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include "globals.hpp"
 #include "Map.hpp"
+#include "tuningConstants.hpp"
 
 class Field;
 
 class WorldMap {
     std::vector<Map> maps;
     std::unordered_map<position, int> world_map;
-    size_t ageIndex = 0;
+
+    // fields which change when aged, spread over buckets which are aged one after another
+    std::unordered_set<position> ageingFields;
+    // size of ageingFields after its last change, read by the gauge on the metrics thread
+    std::atomic<size_t> ageingFieldCount{0};
+    std::vector<std::vector<position>> ageingBuckets{MAP_AGEING_BUCKETS};
+    size_t ageingBucket = 0;
+    size_t ageingIndex = 0;
+    size_t nextAgeingBucket = 0;
 
 public:
     void clear();
@@ -41,7 +54,16 @@ public:
     const Field &walkableNear(position &pos) const;
     bool intersects(const Map &map) const;
 
-    bool allMapsAged();
+    // fields are only aged after being registered, this has to be done
+    // whenever items are put on a field or changed there
+    void registerAgeing(const position &pos);
+    // safe to call from other threads
+    size_t getAgeingFields() const;
+
+    // ages the fields of the current bucket until deadline and calls rotted for every
+    // field whose items changed, returns true once the bucket is aged
+    typedef std::function<void(const position &, const Field &)> rotted_function;
+    bool ageingBucketDone(std::chrono::steady_clock::time_point deadline, const rotted_function &rotted);
 
     bool import(const std::string &importDir, const std::string &mapName);
     bool exportTo(const std::string &exportDir) const;
@@ -138,8 +138,9 @@ auto weight_calc::operator[](key_type const &k) -> mapped_type & {
 
         try {
             Field &field = World::get()->fieldAt(::position(v.first, v.second, level));
-            auto tileId = field.getTileId();
-            insert(std::make_pair(k, Data::Tiles[tileId].walkingCost));
+            // monster turns are planned on several threads, operator[] would record missing tiles
+            const auto *tile = Data::Tiles.find(field.getTileId());
+            insert(std::make_pair(k, tile ? tile->walkingCost : 0));
         } catch (FieldNotFound &) {
             insert(std::make_pair(k, 1));
         }
@@ -0,0 +1,158 @@
+//  illarionserver - server for the game Illarion
+//  Copyright 2011 Illarion e.V.
+//
+//  This file is part of illarionserver.
+//
+//  illarionserver is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  illarionserver is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with illarionserver.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef __bounded_queue_hpp
+#define __bounded_queue_hpp
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstddef>
+#include <utility>
+
+/**
+* multi producer, multi consumer fifo with a fixed capacity
+* used to hand over work between threads
+*
+* items are stored in a preallocated ring, producers block (push)
+* or fail (try_push) while the queue is full
+*/
+template<class T> class bounded_queue {
+public:
+    explicit bounded_queue(size_t capacity) : ring(capacity > 0 ? capacity : 1) {
+    }
+
+    bounded_queue(const bounded_queue &) = delete;
+    bounded_queue &operator=(const bounded_queue &) = delete;
+
+    // blocks while the queue is full
+    void push(T item) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            notFull.wait(lock, [this] { return count < ring.size(); });
+            emplace(std::move(item));
+        }
+        notEmpty.notify_one();
+    }
+
+    // returns false if the queue is full, never blocks
+    bool try_push(T item) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (count == ring.size()) {
+                return false;
+            }
+
+            emplace(std::move(item));
+        }
+        notEmpty.notify_one();
+        return true;
+    }
+
+    // returns false if the queue is empty, never blocks
+    bool try_pop(T &item) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (count == 0) {
+                return false;
+            }
+
+            item = take();
+        }
+        notFull.notify_one();
+        return true;
+    }
+
+    // blocks until an item is available or timeout expired, returns false on timeout
+    template<class Rep, class Period>
+    bool pop(T &item, const std::chrono::duration<Rep, Period> &timeout) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+
+            if (!notEmpty.wait_for(lock, timeout, [this] { return count > 0; })) {
+                return false;
+            }
+
+            item = take();
+        }
+        notFull.notify_one();
+        return true;
+    }
+
+    // moves up to max items to out without blocking, returns the number of items moved
+    template<class OutputIterator>
+    size_t drain(OutputIterator out, size_t max) {
+        size_t drained = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            while (count > 0 && drained < max) {
+                *out++ = take();
+                ++drained;
+            }
+        }
+
+        if (drained > 0) {
+            notFull.notify_all();
+        }
+
+        return drained;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return count;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    size_t capacity() const {
+        return ring.size();
+    }
+
+private:
+    // both require the lock to be held
+    void emplace(T &&item) {
+        ring[(head + count) % ring.size()] = std::move(item);
+        ++count;
+    }
+
+    T take() {
+        T item = std::move(ring[head]);
+        ring[head] = T();
+        head = (head + 1) % ring.size();
+        --count;
+        return item;
+    }
+
+    std::vector<T> ring;
+    size_t head = 0;
+    size_t count = 0;
+
+    mutable std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+};
+
+#endif
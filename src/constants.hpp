@@ -82,6 +82,9 @@ const uint32_t MONSTERVIEWRANGE = 11;
 //! Anzahl der maximal sichtbaren Ebenen nach Unten
 #define RANGEDOWN       0x02
 
+//! upper bound of the screen range of any character, characters farther away are never on screen
+#define MAX_SCREEN_RANGE 30
+
 //! Anzahl der Felder zwischen zwei Ebenen
 #define LEVELDISTANCE 0x03
 
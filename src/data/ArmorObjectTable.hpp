@@ -22,10 +22,11 @@
 #define _ARMOR_OBJECT_TABLE_HPP_
 
 #include "data/StructTable.hpp"
+#include "dense_map.hpp"
 #include "types.hpp"
 #include "TableStructs.hpp"
 
-class ArmorObjectTable : public StructTable<TYPE_OF_ITEM_ID, ArmorStruct> {
+class ArmorObjectTable : public StructTable<TYPE_OF_ITEM_ID, ArmorStruct, dense_map<TYPE_OF_ITEM_ID, ArmorStruct>> {
 public:
     virtual std::string getTableName() override;
     virtual std::vector<std::string> getColumnNames() override;
@@ -23,8 +23,9 @@
 
 #include "types.hpp"
 #include "data/StructTable.hpp"
+#include "dense_map.hpp"
 
-class ContainerObjectTable : public StructTable<TYPE_OF_ITEM_ID, TYPE_OF_CONTAINERSLOTS> {
+class ContainerObjectTable : public StructTable<TYPE_OF_ITEM_ID, TYPE_OF_CONTAINERSLOTS, dense_map<TYPE_OF_ITEM_ID, TYPE_OF_CONTAINERSLOTS>> {
 public:
     virtual std::string getTableName() override;
     virtual std::vector<std::string> getColumnNames() override;
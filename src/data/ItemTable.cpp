@@ -20,6 +20,8 @@
 
 #include "ItemTable.hpp"
 
+uint32_t ItemTable::generation = 0;
+
 std::string ItemTable::getTableName() {
     return "items";
 }
@@ -63,16 +65,21 @@ ItemStruct ItemTable::assignTable(const Database::ResultTuple &row) {
     item.Worth = row["itm_worth"].as<TYPE_OF_WORTH>();
     item.BuyStack = row["itm_buystack"].as<TYPE_OF_BUY_STACK>();
     item.MaxStack = row["itm_maxstack"].as<TYPE_OF_MAX_STACK>();
-    item.serverName = row["itm_name"].as<TYPE_OF_ENGLISH>("");
-    item.German = row["itm_name_german"].as<TYPE_OF_GERMAN>();
-    item.English = row["itm_name_english"].as<TYPE_OF_ENGLISH>();
-    item.GermanDescription = row["itm_description_german"].as<TYPE_OF_GERMAN>();
-    item.EnglishDescription = row["itm_description_english"].as<TYPE_OF_ENGLISH>();
     item.Rareness = row["itm_rareness"].as<int16_t>();
     item.Level = TYPE_OF_ITEMLEVEL(row["itm_level"].as<int16_t>());
     return item;
 }
 
+ItemNames ItemTable::assignNames(const Database::ResultTuple &row) {
+    ItemNames names;
+    names.serverName = row["itm_name"].as<TYPE_OF_ENGLISH>("");
+    names.German = row["itm_name_german"].as<TYPE_OF_GERMAN>();
+    names.English = row["itm_name_english"].as<TYPE_OF_ENGLISH>();
+    names.GermanDescription = row["itm_description_german"].as<TYPE_OF_GERMAN>();
+    names.EnglishDescription = row["itm_description_english"].as<TYPE_OF_ENGLISH>();
+    return names;
+}
+
 std::string ItemTable::assignScriptName(const Database::ResultTuple &row) {
     return row["itm_script"].as<std::string>("");
 }
@@ -81,6 +88,36 @@ auto ItemTable::getQuestScripts() -> NodeRange {
     return QuestNodeTable::getInstance().getItemNodes();
 }
 
+void ItemTable::activateBuffer() {
+    itemNames.swap(itemNamesBuffer);
+    Base::activateBuffer();
+    ++generation;
+}
+
+uint32_t ItemTable::getGeneration() {
+    return generation;
+}
+
+const ItemNames &ItemTable::names(TYPE_OF_ITEM_ID id) const {
+    static const ItemNames missing;
+
+    if (itemNames.count(id) > 0) {
+        return itemNames.at(id);
+    }
+
+    return missing;
+}
+
+void ItemTable::clear() {
+    Base::clear();
+    itemNamesBuffer.clear();
+}
+
+void ItemTable::evaluateRow(const Database::ResultTuple &row) {
+    Base::evaluateRow(row);
+    itemNamesBuffer.emplace(assignId(row), assignNames(row));
+}
+
 /*
 TYPE_OF_ITEM_ID ItemTable::calcInfiniteRot(TYPE_OF_ITEM_ID id, std::map<TYPE_OF_ITEM_ID, bool> &visited, std::map<TYPE_OF_ITEM_ID, bool> &assigned) {
     if (visited[ id ]) {
@@ -24,9 +24,20 @@
 #include "data/QuestScriptStructTable.hpp"
 #include "script/LuaItemScript.hpp"
 #include "TableStructs.hpp"
+#include "dense_map.hpp"
 
-class ItemTable : public QuestScriptStructTable<TYPE_OF_ITEM_ID, ItemStruct, LuaItemScript> {
+class ItemTable : public QuestScriptStructTable<TYPE_OF_ITEM_ID, ItemStruct, LuaItemScript, ItemStruct,
+    dense_map<TYPE_OF_ITEM_ID, ItemStruct>> {
 public:
+    typedef QuestScriptStructTable<TYPE_OF_ITEM_ID, ItemStruct, LuaItemScript, ItemStruct,
+            dense_map<TYPE_OF_ITEM_ID, ItemStruct>> Base;
+
+    virtual void activateBuffer() override;
+    const ItemNames &names(TYPE_OF_ITEM_ID id) const;
+
+    // changes whenever an item table is activated, values derived from item data before are stale
+    static uint32_t getGeneration();
+
     virtual std::string getTableName() override;
     virtual std::vector<std::string> getColumnNames() override;
     virtual TYPE_OF_ITEM_ID assignId(const Database::ResultTuple &row) override;
@@ -34,7 +45,19 @@ public:
     virtual std::string assignScriptName(const Database::ResultTuple &row) override;
     virtual NodeRange getQuestScripts() override;
 
+protected:
+    virtual void clear() override;
+    virtual void evaluateRow(const Database::ResultTuple &row) override;
+
 private:
+    ItemNames assignNames(const Database::ResultTuple &row);
+
+    typedef dense_map<TYPE_OF_ITEM_ID, ItemNames> NamesType;
+    NamesType itemNames;
+    NamesType itemNamesBuffer;
+
+    static uint32_t generation;
+
     //TYPE_OF_ITEM_ID calcInfiniteRot(TYPE_OF_ITEM_ID id, std::map<TYPE_OF_ITEM_ID, bool> &visited, std::map<TYPE_OF_ITEM_ID, bool> &assigned);
 };
 
@@ -25,10 +25,11 @@
 #include "data/QuestNodeTable.hpp"
 #include "Logger.hpp"
 
-template<typename IdType, typename StructType, typename ScriptType, typename ScriptParameter = StructType>
-class QuestScriptStructTable : public ScriptStructTable<IdType, StructType, ScriptType, ScriptParameter> {
+template<typename IdType, typename StructType, typename ScriptType, typename ScriptParameter = StructType,
+         typename ContainerType = std::unordered_map<IdType, StructType>>
+class QuestScriptStructTable : public ScriptStructTable<IdType, StructType, ScriptType, ScriptParameter, ContainerType> {
 public:
-    typedef ScriptStructTable<IdType, StructType, ScriptType, ScriptParameter> Base;
+    typedef ScriptStructTable<IdType, StructType, ScriptType, ScriptParameter, ContainerType> Base;
 
     virtual void reloadScripts() override {
         Base::reloadScripts();
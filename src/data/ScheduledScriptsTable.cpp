@@ -20,6 +20,7 @@
 
 #include "data/ScheduledScriptsTable.hpp"
 
+#include <algorithm>
 #include <iostream>
 
 #include "db/SelectQuery.hpp"
@@ -27,71 +28,94 @@
 
 #include "Logger.hpp"
 #include "Random.hpp"
+#include "Statistics.hpp"
 
 ScheduledScriptsTable::ScheduledScriptsTable() : currentCycle(0), m_dataOk(false) {
     reload();
 }
 
 ScheduledScriptsTable::~ScheduledScriptsTable() {
-    /**@todo destructor implementatiotn*/
     m_table.clear();
 }
 
-bool ScheduledScriptsTable::nextCycle() {
-    currentCycle++;
-    ScriptData data; /**< holds the current task*/
-    int emexit = 0; /**< emergency counter which breaks the loop if to much execution*/
+bool ScheduledScriptsTable::nextCycle(std::chrono::steady_clock::time_point deadline) {
+    if (!cycleRunning) {
+        currentCycle++;
+        cycleRunning = true;
+    }
 
-    while (!m_table.empty() && (emexit < 200) && (m_table.front().nextCycleTime <= currentCycle)) {
-        emexit++;
+    while (!m_table.empty() && m_table.front().data.nextCycleTime <= currentCycle) {
+        std::pop_heap(m_table.begin(), m_table.end(), DueLater());
+        Entry entry = std::move(m_table.back());
+        m_table.pop_back();
 
-        if (emexit>=200) {
-            break;    /**< emergency exit so we can't create an endless loop */
+        if (entry.data.scriptptr) {
+            run(entry);
+            schedule(std::move(entry));
         }
 
-        if (!m_table.empty()) {
-            data = m_table.front(); /**< copy the first data in data*/
-            m_table.pop_front(); /**< deletes the first task */
+        if (std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+    }
+
+    cycleRunning = !m_table.empty() && m_table.front().data.nextCycleTime <= currentCycle;
+    return !cycleRunning;
+}
 
-            if (data.scriptptr) {
-                /**calculate the next time where the script is invoked */
-                data.nextCycleTime = currentCycle + Random::uniform(data.minCycleTime, data.maxCycleTime);
+void ScheduledScriptsTable::run(Entry &entry) {
+    static const auto scriptMetric = Statistic::Statistics::getInstance().registerMetric("scheduled_script");
+    ScriptData &data = entry.data;
+    ScheduledScriptStatistics &statistics = m_statistics[entry.statistics];
 
-                /**call the script function */
-                data.scriptptr->callFunction(data.functionName,currentCycle,data.lastCycleTime,data.nextCycleTime);
+    statistics.delayedCycles += currentCycle - data.nextCycleTime;
 
-                data.lastCycleTime = currentCycle; /**< script was runned and so we can change the lastCycleTime*/
+    /**calculate the next time where the script is invoked, at the earliest in the next cycle */
+    data.nextCycleTime = currentCycle + std::max(1, Random::uniform(data.minCycleTime, data.maxCycleTime));
 
-                addData(data); /**< insert the script in the list again*/
-                return true;
-            }
-        }
-    }
+    const auto start = std::chrono::steady_clock::now();
+    data.scriptptr->callFunction(data.functionName, currentCycle, data.lastCycleTime, data.nextCycleTime);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    data.lastCycleTime = currentCycle;
 
-    return false;
+    Statistic::Statistics::getInstance().record(scriptMetric, elapsed);
+    ++statistics.runs;
+    statistics.total += elapsed;
+    statistics.longest = std::max(statistics.longest, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed));
 }
 
 bool ScheduledScriptsTable::addData(ScriptData data) {
     Logger::debug(LogFacility::Script) << "insert new Task task.nextCycle: " << data.nextCycleTime << " current Cycle: " << currentCycle << Log::end;
-    bool inserted = false;
 
     if (data.nextCycleTime <= currentCycle) {
-        data.nextCycleTime = currentCycle + Random::uniform(data.minCycleTime, data.maxCycleTime);
+        data.nextCycleTime = currentCycle + std::max(1, Random::uniform(data.minCycleTime, data.maxCycleTime));
     }
 
-    for (auto it = m_table.begin(); it != m_table.end(); ++it) {
-        if (it->nextCycleTime > data.nextCycleTime) {
-            m_table.insert(it, data);
-            inserted = true;
-            break;
-        }
-    }
+    m_statistics.push_back({data.scriptName, data.functionName, 0, std::chrono::nanoseconds::zero(), std::chrono::nanoseconds::zero(), 0});
+    schedule({std::move(data), 0, m_statistics.size() - 1});
+    return true;
+}
 
-    if (!inserted) {
-        m_table.push_back(data);
+void ScheduledScriptsTable::schedule(Entry entry) {
+    entry.sequence = nextSequence++;
+    m_table.push_back(std::move(entry));
+    std::push_heap(m_table.begin(), m_table.end(), DueLater());
+}
+
+std::vector<ScheduledScriptStatistics> ScheduledScriptsTable::getStatistics(bool reset) {
+    std::vector<ScheduledScriptStatistics> result = m_statistics;
+
+    if (reset) {
+        for (auto &statistics : m_statistics) {
+            statistics.runs = 0;
+            statistics.total = std::chrono::nanoseconds::zero();
+            statistics.longest = std::chrono::nanoseconds::zero();
+            statistics.delayedCycles = 0;
+        }
     }
 
-    return true;
+    return result;
 }
 
 void ScheduledScriptsTable::reload() {
@@ -138,5 +162,6 @@ void ScheduledScriptsTable::reload() {
 
 void ScheduledScriptsTable::clearOldTable() {
     m_table.clear();
+    m_statistics.clear();
 }
 
@@ -22,10 +22,9 @@
 #define _SCHEDULED_SCRIPTS_TABLE_HPP_
 
 #include <string>
-#include <map>
-#include <list>
+#include <vector>
 #include <memory>
-#include <boost/unordered_map.hpp>
+#include <chrono>
 #include "script/LuaScheduledScript.hpp"
 
 class World;
@@ -53,6 +52,26 @@ struct ScriptData {
     }
 };
 
+/**
+* run time accounting of one scheduled script function
+*/
+struct ScheduledScriptStatistics {
+    std::string scriptName;
+    std::string functionName;
+    uint64_t runs;
+    std::chrono::nanoseconds total;
+    std::chrono::nanoseconds longest;
+    // cycles the script was run later than planned, summed over all runs
+    uint64_t delayedCycles;
+};
+
+/**
+* runs the scheduled scripts, one cycle per second
+*
+* scripts wait in a binary heap ordered by the cycle they are due in, scripts due
+* in the same cycle run in the order they were scheduled. A cycle runs all due
+* scripts, if the deadline passes before that the cycle is resumed by the next call.
+*/
 class ScheduledScriptsTable {
 public:
     ScheduledScriptsTable();
@@ -62,15 +81,40 @@ public:
         return m_dataOk;
     }
 
-    bool nextCycle();
+    // returns true once all scripts due in the current cycle have been run
+    bool nextCycle(std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
 
     bool addData(ScriptData data);
 
+    std::vector<ScheduledScriptStatistics> getStatistics(bool reset = false);
+
 private:
+    struct Entry {
+        ScriptData data;
+        uint64_t sequence;
+        size_t statistics;
+    };
+
+    // orders the heap so that the entry due first is at the front
+    struct DueLater {
+        bool operator()(const Entry &a, const Entry &b) const {
+            if (a.data.nextCycleTime != b.data.nextCycleTime) {
+                return a.data.nextCycleTime > b.data.nextCycleTime;
+            }
+
+            return a.sequence > b.sequence;
+        }
+    };
+
     void reload();
+    void schedule(Entry entry);
+    void run(Entry &entry);
 
-    std::list<ScriptData> m_table;
+    std::vector<Entry> m_table;
+    std::vector<ScheduledScriptStatistics> m_statistics;
+    uint64_t nextSequence = 0;
     uint32_t currentCycle;
+    bool cycleRunning = false;
     bool m_dataOk;
 
     void clearOldTable();
@@ -42,10 +42,11 @@ void detailAssign(std::unordered_map<IdType, std::shared_ptr<ScriptType>> &scrip
 
 }
 
-template<typename IdType, typename StructType, typename ScriptType, typename ScriptParameter = StructType>
-class ScriptStructTable : public StructTable<IdType, StructType> {
+template<typename IdType, typename StructType, typename ScriptType, typename ScriptParameter = StructType,
+         typename ContainerType = std::unordered_map<IdType, StructType>>
+class ScriptStructTable : public StructTable<IdType, StructType, ContainerType> {
 public:
-    typedef StructTable<IdType, StructType> Base;
+    typedef StructTable<IdType, StructType, ContainerType> Base;
 
     virtual void reloadScripts() override {
         scripts.clear();
@@ -106,9 +107,9 @@ private:
     ScriptsType scripts;
 };
 
-template<typename IdType, typename StructType, typename ScriptType, typename ScriptParameter>
+template<typename IdType, typename StructType, typename ScriptType, typename ScriptParameter, typename ContainerType>
 template<typename T>
-void ScriptStructTable<IdType, StructType, ScriptType, ScriptParameter>::internalAssign(const IdType &id, const std::string &name, const StructType &data) {
+void ScriptStructTable<IdType, StructType, ScriptType, ScriptParameter, ContainerType>::internalAssign(const IdType &id, const std::string &name, const StructType &data) {
     detail::detailAssign<IdType, StructType, ScriptType>(scripts, id, name, data, ScriptParameter());
 }
 
@@ -25,14 +25,18 @@
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include "data/Table.hpp"
 #include "db/Result.hpp"
 #include "db/SelectQuery.hpp"
 #include "Logger.hpp"
 
-template<typename IdType, typename StructType>
+/**
+ * ContainerType can be replaced by dense_map for tables with small integer ids,
+ * turning every lookup into an index operation
+ */
+template<typename IdType, typename StructType, typename ContainerType = std::unordered_map<IdType, StructType>>
 class StructTable : public Table {
-    typedef std::unordered_map<IdType, StructType> ContainerType;
 public:
     virtual bool reloadBuffer() override {
         try {
@@ -65,6 +69,7 @@ public:
     virtual void activateBuffer() override {
         structs.swap(structBuffer);
         isBufferValid = false;
+        reportedMissing.clear();
         clear();
     }
 
@@ -73,18 +78,28 @@ public:
     }
 
     const StructType &operator[](const IdType &id) {
-        try {
+        if (structs.count(id) > 0) {
             return structs.at(id);
-        } catch (std::out_of_range &) {
+        }
+
+        if (reportedMissing.insert(id).second) {
             Logger::error(LogFacility::Script) << "Table " << getTableName() << ": entry " << id << " was not found!" << Log::end;
-            return structs[id];
         }
+
+        static const StructType missing{};
+        return missing;
     }
 
     const StructType &get(const IdType &id) const {
         return structs.at(id);
     }
 
+    // read only lookup without reporting missing entries, safe while other threads read the table
+    const StructType *find(const IdType &id) const {
+        const auto it = structs.find(id);
+        return it != structs.end() ? &it->second : nullptr;
+    }
+
     typename ContainerType::const_iterator begin() const {
         return structs.cbegin();
     }
@@ -122,6 +137,7 @@ protected:
 private:
     ContainerType structs;
     ContainerType structBuffer;
+    std::unordered_set<IdType> reportedMissing;
     bool isBufferValid = false;
 };
 
@@ -22,11 +22,13 @@
 #define _TILES_TABLE_HPP_
 
 #include "data/ScriptStructTable.hpp"
+#include "dense_map.hpp"
 #include "types.hpp"
 #include "TableStructs.hpp"
 #include "script/LuaTileScript.hpp"
 
-class TilesTable : public ScriptStructTable<TYPE_OF_TILE_ID, TilesStruct, LuaTileScript> {
+class TilesTable : public ScriptStructTable<TYPE_OF_TILE_ID, TilesStruct, LuaTileScript, TilesStruct,
+    dense_map<TYPE_OF_TILE_ID, TilesStruct>> {
 public:
     virtual std::string getTableName() override;
     virtual std::vector<std::string> getColumnNames() override;
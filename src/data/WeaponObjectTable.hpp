@@ -22,11 +22,13 @@
 #define _WEAPON_OBJECT_TABLE_HPP_
 
 #include "data/ScriptStructTable.hpp"
+#include "dense_map.hpp"
 #include "types.hpp"
 #include "TableStructs.hpp"
 #include "script/LuaWeaponScript.hpp"
 
-class WeaponObjectTable : public ScriptStructTable<TYPE_OF_ITEM_ID, WeaponStruct, LuaWeaponScript> {
+class WeaponObjectTable : public ScriptStructTable<TYPE_OF_ITEM_ID, WeaponStruct, LuaWeaponScript, WeaponStruct,
+    dense_map<TYPE_OF_ITEM_ID, WeaponStruct>> {
 public:
     virtual std::string getTableName() override;
     virtual std::vector<std::string> getColumnNames() override;
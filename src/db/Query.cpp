@@ -23,9 +23,20 @@
 #include "db/ConnectionManager.hpp"
 
 #include <stdexcept>
+#include <utility>
 
 using namespace Database;
 
+namespace {
+
+Query::observer_type observer;
+
+}
+
+void Query::setObserver(observer_type newObserver) {
+    observer = std::move(newObserver);
+}
+
 Query::Query() {
     dbConnection = ConnectionManager::getInstance().getConnection();
 }
@@ -48,6 +59,8 @@ Result Query::execute() {
             "Connection and query string are required to execute the query.");
     }
 
+    const auto start = std::chrono::steady_clock::now();
+
     bool ownTransaction = ! dbConnection->transactionActive();
 
     if (ownTransaction) {
@@ -60,6 +73,10 @@ Result Query::execute() {
         dbConnection->commitTransaction();
     }
 
+    if (observer) {
+        observer(std::chrono::steady_clock::now() - start);
+    }
+
     return result;
 }
 
@@ -21,6 +21,8 @@
 #ifndef _QUERY_HPP_
 #define _QUERY_HPP_
 
+#include <chrono>
+#include <functional>
 #include <string>
 
 #include "db/Connection.hpp"
@@ -45,6 +47,13 @@ public:
 
     virtual Result execute();
 
+    typedef std::function<void(std::chrono::steady_clock::duration)> observer_type;
+    /**
+    * the observer is called with the duration of every executed query,
+    * set it before the first query is executed since it is not synchronised
+    */
+    static void setObserver(observer_type observer);
+
 protected:
     Query();
     Query(const PConnection connection);
@@ -0,0 +1,282 @@
+//  illarionserver - server for the game Illarion
+//  Copyright 2011 Illarion e.V.
+//
+//  This file is part of illarionserver.
+//
+//  illarionserver is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  illarionserver is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with illarionserver.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef __dense_map_hpp
+#define __dense_map_hpp
+
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include <cstddef>
+#include <utility>
+#include <iterator>
+
+/**
+* map for small unsigned integer keys, stored in a vector indexed by key
+*
+* lookups are an index operation instead of hashing or walking a tree, the
+* vector grows up to the largest key ever inserted; a bitmap marks used keys
+* so that iteration and the search for the first unused key look at 64 keys
+* at once; iteration visits entries in ascending key order
+*/
+template<typename Key, typename T> class dense_map {
+public:
+    typedef Key key_type;
+    typedef T mapped_type;
+    typedef std::pair<Key, T> value_type;
+
+private:
+    typedef uint64_t word_type;
+    static constexpr size_t wordBits = 64;
+
+    template<typename Map, typename Value> class basic_iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef std::pair<Key, T> value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef Value *pointer;
+        typedef Value &reference;
+
+        basic_iterator() = default;
+
+        // iterator converts to const_iterator
+        template<typename OtherMap, typename OtherValue>
+        basic_iterator(const basic_iterator<OtherMap, OtherValue> &other) : map(other.map), index(other.index) {
+        }
+
+        Value &operator*() const {
+            return map->slots[index];
+        }
+
+        Value *operator->() const {
+            return &map->slots[index];
+        }
+
+        basic_iterator &operator++() {
+            index = map->nextUsed(index + 1);
+            return *this;
+        }
+
+        basic_iterator operator++(int) {
+            basic_iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const basic_iterator &other) const {
+            return index == other.index;
+        }
+
+        bool operator!=(const basic_iterator &other) const {
+            return index != other.index;
+        }
+
+    private:
+        friend class dense_map;
+        template<typename, typename> friend class basic_iterator;
+
+        basic_iterator(Map *map, size_t index) : map(map), index(index) {
+        }
+
+        Map *map = nullptr;
+        size_t index = 0;
+    };
+
+public:
+    typedef basic_iterator<dense_map, value_type> iterator;
+    typedef basic_iterator<const dense_map, const value_type> const_iterator;
+
+    size_t count(const Key &key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    iterator find(const Key &key) {
+        return contains(key) ? iterator(this, index(key)) : end();
+    }
+
+    const_iterator find(const Key &key) const {
+        return contains(key) ? const_iterator(this, index(key)) : end();
+    }
+
+    const T &at(const Key &key) const {
+        if (!contains(key)) {
+            throw std::out_of_range("dense_map::at");
+        }
+
+        return slots[index(key)].second;
+    }
+
+    T &at(const Key &key) {
+        if (!contains(key)) {
+            throw std::out_of_range("dense_map::at");
+        }
+
+        return slots[index(key)].second;
+    }
+
+    T &operator[](const Key &key) {
+        if (!contains(key)) {
+            store(key, T());
+        }
+
+        return slots[index(key)].second;
+    }
+
+    bool emplace(const Key &key, const T &value) {
+        return insert(value_type(key, value)).second;
+    }
+
+    std::pair<iterator, bool> insert(const value_type &value) {
+        if (contains(value.first)) {
+            return {find(value.first), false};
+        }
+
+        store(value.first, value.second);
+        return {iterator(this, index(value.first)), true};
+    }
+
+    // the hint is only accepted for compatibility with std::map
+    iterator insert(const_iterator, const value_type &value) {
+        return insert(value).first;
+    }
+
+    size_t erase(const Key &key) {
+        if (!contains(key)) {
+            return 0;
+        }
+
+        release(index(key));
+        return 1;
+    }
+
+    iterator erase(const_iterator position) {
+        release(position.index);
+        return iterator(this, nextUsed(position.index + 1));
+    }
+
+    void clear() {
+        slots.clear();
+        used.clear();
+        entries = 0;
+    }
+
+    void swap(dense_map &other) {
+        slots.swap(other.slots);
+        used.swap(other.used);
+        std::swap(entries, other.entries);
+    }
+
+    size_t size() const {
+        return entries;
+    }
+
+    bool empty() const {
+        return entries == 0;
+    }
+
+    // smallest key without an entry
+    Key first_unused() const {
+        for (size_t word = 0; word < used.size(); ++word) {
+            if (~used[word] != 0) {
+                return static_cast<Key>(word * wordBits + __builtin_ctzll(~used[word]));
+            }
+        }
+
+        return static_cast<Key>(used.size() * wordBits);
+    }
+
+    iterator begin() {
+        return iterator(this, nextUsed(0));
+    }
+
+    iterator end() {
+        return iterator(this, slots.size());
+    }
+
+    const_iterator begin() const {
+        return const_iterator(this, nextUsed(0));
+    }
+
+    const_iterator end() const {
+        return const_iterator(this, slots.size());
+    }
+
+    const_iterator cbegin() const {
+        return begin();
+    }
+
+    const_iterator cend() const {
+        return end();
+    }
+
+private:
+    static size_t index(const Key &key) {
+        return static_cast<size_t>(key);
+    }
+
+    bool contains(const Key &key) const {
+        const size_t i = index(key);
+        return i < slots.size() && (used[i / wordBits] >> (i % wordBits) & 1) != 0;
+    }
+
+    // index of the first used slot at or after i, slots.size() if there is none
+    size_t nextUsed(size_t i) const {
+        if (i >= slots.size()) {
+            return slots.size();
+        }
+
+        size_t word = i / wordBits;
+        word_type bits = used[word] & (~word_type(0) << (i % wordBits));
+
+        while (bits == 0) {
+            if (++word == used.size()) {
+                return slots.size();
+            }
+
+            bits = used[word];
+        }
+
+        return word * wordBits + __builtin_ctzll(bits);
+    }
+
+    void store(const Key &key, const T &value) {
+        const size_t i = index(key);
+
+        if (i >= slots.size()) {
+            slots.resize(i + 1);
+            used.resize(i / wordBits + 1, 0);
+        }
+
+        slots[i] = value_type(key, value);
+        used[i / wordBits] |= word_type(1) << (i % wordBits);
+        ++entries;
+    }
+
+    void release(size_t i) {
+        slots[i].second = T();
+        used[i / wordBits] &= ~(word_type(1) << (i % wordBits));
+        --entries;
+    }
+
+    std::vector<value_type> slots;
+    std::vector<word_type> used;
+    size_t entries = 0;
+};
+
+#endif
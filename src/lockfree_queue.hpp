@@ -0,0 +1,141 @@
+//  illarionserver - server for the game Illarion
+//  Copyright 2011 Illarion e.V.
+//
+//  This file is part of illarionserver.
+//
+//  illarionserver is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  illarionserver is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with illarionserver.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef __lockfree_queue_hpp
+#define __lockfree_queue_hpp
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+/**
+* multi producer, multi consumer fifo with a fixed capacity which never blocks
+*
+* every slot carries a sequence number telling producers and consumers
+* whether it is free or filled for their current position, so pushing
+* and popping only needs one compare and swap on the shared position
+*
+* the capacity is rounded up to the next power of two
+*/
+template<class T> class lockfree_queue {
+public:
+    explicit lockfree_queue(size_t capacity) : mask(roundUp(capacity) - 1), cells(new Cell[mask + 1]) {
+        for (size_t i = 0; i <= mask; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    lockfree_queue(const lockfree_queue &) = delete;
+    lockfree_queue &operator=(const lockfree_queue &) = delete;
+
+    // returns false if the queue is full
+    bool try_push(T &&item) {
+        Cell *cell;
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+
+        while (true) {
+            cell = &cells[pos & mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+
+            if (difference == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->item = std::move(item);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // returns false if the queue is empty
+    bool try_pop(T &item) {
+        Cell *cell;
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+
+        while (true) {
+            cell = &cells[pos & mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+
+            if (difference == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        item = std::move(cell->item);
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // approximate while other threads push or pop
+    size_t size() const {
+        const size_t enqueued = enqueuePos.load(std::memory_order_relaxed);
+        const size_t dequeued = dequeuePos.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    size_t capacity() const {
+        return mask + 1;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T item;
+    };
+
+    static size_t roundUp(size_t capacity) {
+        size_t result = 2;
+
+        while (result < capacity) {
+            result <<= 1;
+        }
+
+        return result;
+    }
+
+    const size_t mask;
+    std::unique_ptr<Cell[]> cells;
+
+    // keep producers and consumers on different cache lines
+    char padding0[64];
+    std::atomic<size_t> enqueuePos = {0};
+    char padding1[64];
+    std::atomic<size_t> dequeuePos = {0};
+};
+
+#endif
@@ -22,8 +22,10 @@
 #include <config.h>
 #endif
 
+#include <iterator>
 #include <memory>
 #include <sstream>
+#include <vector>
 
 #include "Field.hpp"
 #include "Player.hpp"
@@ -45,6 +47,7 @@
 
 #include "db/SchemaHelper.hpp"
 #include "db/ConnectionManager.hpp"
+#include "db/Query.hpp"
 #include "db/SchemaHelper.hpp"
 
 #include "script/LuaLoginScript.hpp"
@@ -72,12 +75,20 @@ int main(int argc, char *argv[]) {
         throw std::runtime_error("failed to process commandline arguments");
     }
 
+    if (!Logger::setLogFile(Config::instance().log_file())) {
+        Logger::error(LogFacility::Other) << "main: could not open log file " << Config::instance().log_file() << Log::end;
+    }
+
     Logger::info(LogFacility::Other) << "main: server requires clientversion: " << Config::instance().clientversion << Log::end;
     Logger::info(LogFacility::Other) << "main: listen port: " << Config::instance().port << Log::end;
     Logger::info(LogFacility::Other) << "main: data directory: " << Config::instance().datadir() << Log::end;
     Logger::notice(LogFacility::Script) << "Initialising script log ..." << Log::end;
 
     // initialise DB Manager
+    const auto queryMetric = Statistic::Statistics::getInstance().registerMetric("db_query");
+    Database::Query::setObserver([queryMetric](std::chrono::steady_clock::duration duration) {
+        Statistic::Statistics::getInstance().record(queryMetric, duration);
+    });
     Database::ConnectionManager::getInstance().setupManager();
     Database::SchemaHelper::setSchemata();
 
@@ -105,7 +116,9 @@ int main(int argc, char *argv[]) {
     Logger::info(LogFacility::Other) << "create PlayerManager" << Log::end;
     PlayerManager::get().activate();
     Logger::info(LogFacility::Other) << "PlayerManager activated" << Log::end;
-    PlayerManager::TPLAYERVECTOR &newplayers = PlayerManager::get().getLogInPlayers();
+    PlayerManager::TPLAYERQUEUE &newplayers = PlayerManager::get().getLogInPlayers();
+    std::vector<Player *> playersToProcess;
+    playersToProcess.reserve(MAXPLAYERSPROCESSED);
     world->initNPC();
 
     try {
@@ -122,18 +135,21 @@ int main(int argc, char *argv[]) {
     running = true;
 
     using namespace Statistic;
-    Statistics::getInstance().startTimer("cycle");
+    const auto cycle = Statistics::getInstance().registerMetric("cycle");
+    auto cycleStart = std::chrono::steady_clock::now();
+    // the logger keeps totals, the counters get what was added during each cycle
+    const auto logDropped = Statistics::getInstance().registerCounter("log_messages_dropped");
+    const auto logWritten = Statistics::getInstance().registerCounter("log_messages_written");
+    uint64_t loggedDropped = 0;
+    uint64_t loggedWritten = 0;
 
     while (running) {
         // make sure we don't block the server with processing new players...
-        int new_players_processed = 0;
+        playersToProcess.clear();
+        newplayers.drain(std::back_inserter(playersToProcess), MAXPLAYERSPROCESSED);
 
         // process new players from connection thread
-        while (!newplayers.empty() && new_players_processed < MAXPLAYERSPROCESSED) {
-
-            new_players_processed++;
-            Player *newPlayer = newplayers.pop_front();
-
+        for (auto newPlayer : playersToProcess) {
             if (newPlayer) {
                 login_save(newPlayer);
 
@@ -148,16 +164,27 @@ int main(int argc, char *argv[]) {
                     } catch (Player::LogoutException &e) {
                         ServerCommandPointer cmd = std::make_shared<LogOutTC>(e.getReason());
                         newPlayer->Connection->shutdownSend(cmd);
-                        PlayerManager::get().getLogOutPlayers().push_back(newPlayer);
+                        PlayerManager::get().logoutPlayer(newPlayer);
                     }
                 }
+
+                PlayerManager::get().loginFinished(newPlayer->getName());
             }
         }
 
         // run scheduler until next task or for 25ms
         world->scheduler.run_once(std::chrono::seconds(1));
         world->checkPlayerImmediateCommands();
-        Statistics::getInstance().stopTimer("cycle");
+        const auto cycleEnd = std::chrono::steady_clock::now();
+        Statistics::getInstance().record(cycle, cycleEnd - cycleStart);
+        cycleStart = cycleEnd;
+
+        const auto dropped = Logger::getDroppedMessages();
+        const auto written = Logger::getWrittenMessages();
+        Statistics::getInstance().increment(logDropped, dropped - loggedDropped);
+        Statistics::getInstance().increment(logWritten, written - loggedWritten);
+        loggedDropped = dropped;
+        loggedWritten = written;
     }
 
 
@@ -177,6 +204,7 @@ int main(int argc, char *argv[]) {
     reset_sighandlers();
 
     Logger::info(LogFacility::Other) << "Illarion has been successfully terminated! " << Log::end;
+    Logger::flush();
 
     return 0;
 }
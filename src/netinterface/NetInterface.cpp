@@ -19,14 +19,20 @@
 
 #include <iomanip>
 #include <functional>
+#include <algorithm>
 #include "netinterface/BasicClientCommand.hpp"
 #include "netinterface/protocol/ClientCommands.hpp"
+#include "netinterface/protocol/ServerCommands.hpp"
 #include "CommandFactory.hpp"
 #include "Player.hpp"
+#include "constants.hpp"
+#include "tuningConstants.hpp"
 
 #include "netinterface/NetInterface.hpp"
 
-NetInterface::NetInterface(boost::asio::io_service &io_servicen) : online(false), socket(io_servicen), inactive(0) {
+std::atomic<int> NetInterface::openConnections{0};
+
+NetInterface::NetInterface(boost::asio::io_service &io_servicen) : online(false), socket(io_servicen), loginTimer(io_servicen) {
     cmd.reset();
 }
 
@@ -36,6 +42,10 @@ std::string NetInterface::getIPAdress() {
 
 
 NetInterface::~NetInterface() {
+    if (counted) {
+        openConnections.fetch_sub(1, std::memory_order_relaxed);
+    }
+
     try {
         online = false;
         sendQueue.clear();
@@ -59,6 +69,18 @@ bool NetInterface::activate(Player* player) {
         boost::asio::async_read(socket,boost::asio::buffer(headerBuffer,6), std::bind(&NetInterface::handle_read_header, shared_from_this(), std::placeholders::_1));
         ipadress = socket.remote_endpoint().address().to_string();
         online = true;
+
+        // a connection is activated once for login and once more for the player
+        if (!counted) {
+            counted = true;
+            openConnections.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (!owner) {
+            loginTimer.expires_after(std::chrono::seconds(LOGIN_TIMEOUT));
+            loginTimer.async_wait(std::bind(&NetInterface::handle_login_timeout, shared_from_this(), std::placeholders::_1));
+        }
+
         return true;
     } catch (std::exception &e) {
         Logger::error(LogFacility::Other) << "Error in NetInterface::activate for " << player->to_string() << ": " << e.what() << Log::end;
@@ -85,6 +107,12 @@ void NetInterface::handle_read_data(const boost::system::error_code &error) {
                         }
                         
                         loginData = login;
+                        loginTimer.cancel();
+
+                        if (loginHandler) {
+                            loginHandler(shared_from_this());
+                        }
+
                         return;
                     } else {
                         owner->receiveCommand(cmd);
@@ -117,9 +145,12 @@ void NetInterface::handle_read_data(const boost::system::error_code &error) {
     }
 }
 
-bool NetInterface::nextInactive() {
-    inactive++;
-    return (inactive > 1000);
+void NetInterface::handle_login_timeout(const boost::system::error_code &error) {
+    if (error != boost::asio::error::operation_aborted && !loginData && online) {
+        Logger::info(LogFacility::Other) << "Connection from " << getIPAdress() << " did not send login data in time" << Log::end;
+        ServerCommandPointer cmd = std::make_shared<LogOutTC>(UNSTABLECONNECTION);
+        shutdownSend(cmd);
+    }
 }
 
 void NetInterface::handle_read_header(const boost::system::error_code &error) {
@@ -172,6 +203,9 @@ void NetInterface::handle_read_header(const boost::system::error_code &error) {
 
         closeConnection();
 
+        if (!owner) {
+            loginTimer.cancel();
+        }
     }
 }
 
@@ -185,8 +219,7 @@ void NetInterface::addCommand(const ServerCommandPointer &command) {
 
         try {
             if (!write_in_progress && online) {
-                boost::asio::async_write(socket,boost::asio::buffer(sendQueue.front()->cmdData(),sendQueue.front()->getLength()),
-                                         std::bind(&NetInterface::handle_write, shared_from_this(), std::placeholders::_1));
+                startWrite();
             }
         } catch (std::exception &e) {
             Logger::error(LogFacility::Other) << "Exception in NetInterface::addCommand: " << e.what() << Log::end;
@@ -195,6 +228,42 @@ void NetInterface::addCommand(const ServerCommandPointer &command) {
     }
 }
 
+void NetInterface::addCommands(const std::vector<ServerCommandPointer> &commands) {
+    if (online && !commands.empty()) {
+        for (const auto &command : commands) {
+            command->addHeader();
+        }
+
+        std::lock_guard<std::mutex> lock(sendQueueMutex);
+        bool write_in_progress = !sendQueue.empty();
+        sendQueue.insert(sendQueue.end(), commands.begin(), commands.end());
+
+        try {
+            if (!write_in_progress && online) {
+                startWrite();
+            }
+        } catch (std::exception &e) {
+            Logger::error(LogFacility::Other) << "Exception in NetInterface::addCommands: " << e.what() << Log::end;
+            closeConnection();
+        }
+    }
+}
+
+void NetInterface::startWrite() {
+    writeBuffers.clear();
+
+    for (const auto &command : sendQueue) {
+        if (writeBuffers.size() == MAX_COMMANDS_PER_WRITE) {
+            break;
+        }
+
+        writeBuffers.push_back(boost::asio::buffer(command->cmdData(), command->getLength()));
+    }
+
+    boost::asio::async_write(socket, writeBuffers,
+                             std::bind(&NetInterface::handle_write, shared_from_this(), std::placeholders::_1));
+}
+
 void NetInterface::shutdownSend(const ServerCommandPointer &command) {
     try {
         command->addHeader();
@@ -212,11 +281,10 @@ void NetInterface::handle_write(const boost::system::error_code &error) {
         if (!error) {
             if (online) {
                 std::lock_guard<std::mutex> lock(sendQueueMutex);
-                sendQueue.pop_front();
+                sendQueue.erase(sendQueue.begin(), sendQueue.begin() + std::min(writeBuffers.size(), sendQueue.size()));
 
                 if (!sendQueue.empty() && online) {
-                    boost::asio::async_write(socket,boost::asio::buffer(sendQueue.front()->cmdData(),sendQueue.front()->getLength()),
-                                             std::bind(&NetInterface::handle_write, shared_from_this(), std::placeholders::_1));
+                    startWrite();
                 }
             }
         } else {
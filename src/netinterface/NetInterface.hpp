@@ -25,16 +25,17 @@
 */
 
 
-//include thread save vector
-#include "thread_safe_vector.hpp"
-
 #include "Connection.hpp"
 #include "netinterface/BasicClientCommand.hpp"
 #include "netinterface/BasicServerCommand.hpp"
 #include "netinterface/CommandFactory.hpp"
+#include <atomic>
 #include <memory>
+#include <functional>
 #include <boost/asio.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <deque>
+#include <vector>
 #include <mutex>
 
 class LoginCommandTS;
@@ -62,9 +63,19 @@ public:
     */
     ~NetInterface();
 
+    using LoginHandler = std::function<void(const std::shared_ptr<NetInterface> &)>;
+
     void closeConnection(); /*<closes the connection to the client*/
     bool activate(Player* = nullptr); /*<activates the connection starts the sending and receiving threads, if player == nullptr only login command is accepted and processing stops afterwards*/
-    bool nextInactive();
+
+    /**
+    * sets the handler which is called from the io thread as soon as the login command has been received
+    * connections which do not send a login command within LOGIN_TIMEOUT seconds are logged out
+    * @param handler the function which takes over the connection
+    */
+    void setLoginHandler(const LoginHandler &handler) {
+        loginHandler = handler;
+    }
 
     /**
     * adds a command to the send queue so it will be sended correctly to the connection
@@ -72,6 +83,12 @@ public:
     */
     void addCommand(const ServerCommandPointer &command);
 
+    /**
+    * adds several commands to the send queue at once, they are written together
+    * @param commands the commands which should be added, in order
+    */
+    void addCommands(const std::vector<ServerCommandPointer> &commands);
+
     void shutdownSend(const ServerCommandPointer &command);
 
     std::string getIPAdress();
@@ -88,13 +105,23 @@ public:
 	    return loginData;
     }
 
+    /**
+    * number of activated connections which have not been destroyed yet
+    */
+    static int getOpenConnections() {
+        return openConnections.load(std::memory_order_relaxed);
+    }
+
 private:
 
     void handle_read_header(const boost::system::error_code &error);
     void handle_read_data(const boost::system::error_code &error);
 
+    // writes all queued commands at once, requires sendQueueMutex to be held and no write in progress
+    void startWrite();
     void handle_write(const boost::system::error_code &error);
     void handle_write_shutdown(const boost::system::error_code &error);
+    void handle_login_timeout(const boost::system::error_code &error);
 
     //Buffer for the header of messages
     unsigned char headerBuffer[6];
@@ -104,6 +131,8 @@ private:
     ServerCommandPointer cmdToWrite;
 
     SERVERCOMMANDLIST sendQueue;
+    // buffers of the commands at the front of sendQueue which are being written
+    std::vector<boost::asio::const_buffer> writeBuffers;
 
     std::string ipadress;
 
@@ -111,11 +140,15 @@ private:
 
     //Factory für Commands vom Client
     CommandFactory commandFactory;
-    uint16_t inactive;
     std::mutex sendQueueMutex;
     std::shared_ptr<LoginCommandTS> loginData;
+    LoginHandler loginHandler;
+    boost::asio::steady_timer loginTimer;
 
     Player* owner;
+
+    bool counted = false;
+    static std::atomic<int> openConnections;
 };
 
 
@@ -495,27 +495,43 @@ MapStripeTC::MapStripeTC(const position &pos, NewClientView::stripedirection dir
     addUnsignedCharToBuffer(numberOfTiles);
 
     for (int i = 0; i < numberOfTiles; ++i) {
-        if (fields[i]) {
-            addShortIntToBuffer(fields[i]->getTileCode());
-            addUnsignedCharToBuffer(fields[i]->getMovementCost());
-            addShortIntToBuffer(fields[i]->getMusicId());
-            addUnsignedCharToBuffer(static_cast<unsigned char>(fields[i]->itemCount()));
-
-            for (const auto &item : fields[i]->getItemStack()) {
-                addShortIntToBuffer(item.getId());
-
-                if (item.isContainer()) {
-                    addShortIntToBuffer(1);
-                } else {
-                    addShortIntToBuffer(item.getNumber());
-                }
+        addFieldToBuffer(fields[i]);
+    }
+}
+
+MapStripeTC::MapStripeTC(const position &pos, NewClientView::stripedirection dir, const std::vector<const Field *> &fields) : BasicServerCommand(SC_MAPSTRIPE_TC) {
+    addShortIntToBuffer(pos.x);
+    addShortIntToBuffer(pos.y);
+    addShortIntToBuffer(pos.z);
+    addUnsignedCharToBuffer(static_cast<unsigned char>(dir));
+    addUnsignedCharToBuffer(static_cast<unsigned char>(fields.size()));
+
+    for (const auto &field : fields) {
+        addFieldToBuffer(field);
+    }
+}
+
+void MapStripeTC::addFieldToBuffer(const Field *field) {
+    if (field) {
+        addShortIntToBuffer(field->getTileCode());
+        addUnsignedCharToBuffer(field->getMovementCost());
+        addShortIntToBuffer(field->getMusicId());
+        addUnsignedCharToBuffer(static_cast<unsigned char>(field->itemCount()));
+
+        for (const auto &item : field->getItemStack()) {
+            addShortIntToBuffer(item.getId());
+
+            if (item.isContainer()) {
+                addShortIntToBuffer(1);
+            } else {
+                addShortIntToBuffer(item.getNumber());
             }
-        } else {
-            addShortIntToBuffer(-1);
-            addUnsignedCharToBuffer(0);
-            addShortIntToBuffer(0);
-            addUnsignedCharToBuffer(0);
         }
+    } else {
+        addShortIntToBuffer(-1);
+        addUnsignedCharToBuffer(0);
+        addShortIntToBuffer(0);
+        addUnsignedCharToBuffer(0);
     }
 }
 
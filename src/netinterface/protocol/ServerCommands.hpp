@@ -291,6 +291,11 @@ public:
 class MapStripeTC : public BasicServerCommand {
 public:
     MapStripeTC(const position &pos, NewClientView::stripedirection dir);
+    // stripe of the given fields, which have to lie next to each other in direction dir
+    MapStripeTC(const position &pos, NewClientView::stripedirection dir, const std::vector<const Field *> &fields);
+
+private:
+    void addFieldToBuffer(const Field *field);
 };
 
 class MapCompleteTC : public BasicServerCommand {
@@ -0,0 +1,99 @@
+/*
+ *  illarionserver - server for the game Illarion
+ *  Copyright 2011 Illarion e.V.
+ *
+ *  This file is part of illarionserver.
+ *
+ *  illarionserver is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  illarionserver is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with illarionserver.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "script/LuaGarbageCollector.hpp"
+
+extern "C" {
+#include <lua.h>
+}
+
+#include "Config.hpp"
+#include "Logger.hpp"
+#include "Statistics.hpp"
+#include "tuningConstants.hpp"
+
+std::atomic<uint64_t> LuaGarbageCollector::heapSize{0};
+
+namespace {
+
+uint64_t currentHeapSize(lua_State *L) {
+    return static_cast<uint64_t>(lua_gc(L, LUA_GCCOUNT, 0)) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+}
+
+}
+
+void LuaGarbageCollector::configure(lua_State *L) {
+    const std::string mode = Config::instance().lua_gc_mode;
+
+    if (mode == "generational") {
+#ifdef LUA_GCGEN
+        lua_gc(L, LUA_GCGEN, 0);
+#else
+        Logger::warn(LogFacility::Script) << "Lua has no generational garbage collector, using incremental mode" << Log::end;
+#endif
+    } else {
+#ifdef LUA_GCINC
+        lua_gc(L, LUA_GCINC, 0);
+#endif
+
+        if (mode != "incremental") {
+            Logger::warn(LogFacility::Script) << "Unknown lua_gc_mode " << mode << ", using incremental mode" << Log::end;
+        }
+    }
+
+    const int pause = Config::instance().lua_gc_pause;
+    const int stepMultiplier = Config::instance().lua_gc_stepmul;
+    lua_gc(L, LUA_GCSETPAUSE, pause);
+    lua_gc(L, LUA_GCSETSTEPMUL, stepMultiplier);
+
+    heapSize.store(currentHeapSize(L), std::memory_order_relaxed);
+
+    static bool gaugeRegistered = false;
+
+    if (!gaugeRegistered) {
+        gaugeRegistered = true;
+        Statistic::Statistics::getInstance().registerGauge("lua_heap_bytes", [] {
+            return static_cast<double>(getHeapSize());
+        });
+    }
+}
+
+bool LuaGarbageCollector::step(lua_State *L, std::chrono::steady_clock::time_point deadline) {
+    using Statistic::Statistics;
+    static const auto stepMetric = Statistics::getInstance().registerMetric("lua_gc_step");
+    static const auto cycles = Statistics::getInstance().registerCounter("lua_gc_cycles");
+
+    bool finished = false;
+
+    {
+        Statistic::StopWatch stopWatch(stepMetric);
+
+        do {
+            finished = lua_gc(L, LUA_GCSTEP, LUA_GC_STEP_SIZE) != 0;
+        } while (!finished && std::chrono::steady_clock::now() < deadline);
+    }
+
+    if (finished) {
+        Statistics::getInstance().increment(cycles);
+    }
+
+    heapSize.store(currentHeapSize(L), std::memory_order_relaxed);
+    return finished;
+}
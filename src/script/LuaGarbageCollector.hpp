@@ -0,0 +1,57 @@
+/*
+ *  illarionserver - server for the game Illarion
+ *  Copyright 2011 Illarion e.V.
+ *
+ *  This file is part of illarionserver.
+ *
+ *  illarionserver is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  illarionserver is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with illarionserver.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _LUA_GARBAGE_COLLECTOR_HPP_
+#define _LUA_GARBAGE_COLLECTOR_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+struct lua_State;
+
+/**
+* controls the garbage collector of the Lua state
+*
+* the collector runs in the mode configured by lua_gc_mode, additionally
+* the game loop pays off collection work in small steps between scheduler
+* tasks, so less of it happens in the middle of a script call
+*/
+class LuaGarbageCollector {
+public:
+    // applies mode, pause and step multiplier from the config to a new state
+    static void configure(lua_State *L);
+
+    /**
+    * performs incremental collection steps until the deadline or the end of a cycle
+    * @return true if a collection cycle was finished
+    */
+    static bool step(lua_State *L, std::chrono::steady_clock::time_point deadline);
+
+    // heap size in bytes as of the last configure or step, safe to read from any thread
+    static uint64_t getHeapSize() {
+        return heapSize.load(std::memory_order_relaxed);
+    }
+
+private:
+    static std::atomic<uint64_t> heapSize;
+};
+
+#endif
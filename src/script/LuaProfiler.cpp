@@ -0,0 +1,93 @@
+/*
+ *  illarionserver - server for the game Illarion
+ *  Copyright 2011 Illarion e.V.
+ *
+ *  This file is part of illarionserver.
+ *
+ *  illarionserver is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  illarionserver is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with illarionserver.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "script/LuaProfiler.hpp"
+
+#include <algorithm>
+
+#include "Logger.hpp"
+
+LuaProfiler &LuaProfiler::getInstance() {
+    static LuaProfiler instance;
+    return instance;
+}
+
+LuaProfiler::LuaProfiler() : enabled(false), slowCallThreshold(0) {
+}
+
+void LuaProfiler::record(const std::string &script, const std::string &entrypoint, std::chrono::microseconds duration, uint64_t allocated) {
+    const auto us = static_cast<uint64_t>(std::max<int64_t>(0, duration.count()));
+    const auto threshold = slowCallThreshold.load(std::memory_order_relaxed);
+
+    if (threshold > 0 && duration.count() >= threshold) {
+        Logger::warn(LogFacility::Script) << "slow script call: " << script << ":" << entrypoint << " took "
+                                          << us / 1000.0 << "ms and allocated " << allocated << " bytes" << Log::end;
+    }
+
+    if (!isEnabled()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(profileMutex);
+    auto &profile = profiles[script + ":" + entrypoint];
+
+    if (profile.time.buckets.empty()) {
+        profile.script = script;
+        profile.entrypoint = entrypoint;
+        profile.time.name = script + ":" + entrypoint;
+        profile.time.buckets.resize(Statistic::Histogram::BUCKETS, 0);
+    }
+
+    ++profile.time.buckets[Statistic::Histogram::bucketOf(us)];
+    ++profile.time.count;
+    profile.time.sum += us;
+    profile.allocated += allocated;
+}
+
+std::vector<LuaProfile> LuaProfiler::getTop(size_t count) const {
+    auto result = getProfiles();
+
+    std::sort(result.begin(), result.end(), [](const LuaProfile &a, const LuaProfile &b) {
+        return a.time.sum > b.time.sum;
+    });
+
+    if (result.size() > count) {
+        result.resize(count);
+    }
+
+    return result;
+}
+
+std::vector<LuaProfile> LuaProfiler::getProfiles() const {
+    std::lock_guard<std::mutex> lock(profileMutex);
+    std::vector<LuaProfile> result;
+    result.reserve(profiles.size());
+
+    for (const auto &profile : profiles) {
+        result.push_back(profile.second);
+    }
+
+    return result;
+}
+
+void LuaProfiler::reset() {
+    std::lock_guard<std::mutex> lock(profileMutex);
+    profiles.clear();
+}
@@ -0,0 +1,92 @@
+/*
+ *  illarionserver - server for the game Illarion
+ *  Copyright 2011 Illarion e.V.
+ *
+ *  This file is part of illarionserver.
+ *
+ *  illarionserver is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  illarionserver is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with illarionserver.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _LUA_PROFILER_HPP_
+#define _LUA_PROFILER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Statistics.hpp"
+
+/**
+* wall time and heap growth of one script entrypoint
+*
+* times include nested entrypoints called from within the script
+*/
+struct LuaProfile {
+    std::string script;
+    std::string entrypoint;
+    uint64_t allocated = 0; // bytes
+    Statistic::Histogram time; // microseconds
+};
+
+/**
+* optional profiler for all calls into Lua, recording per script and entrypoint
+*
+* while disabled a call costs one atomic load, calls exceeding the
+* slow call threshold are logged even if profiling is disabled
+*/
+class LuaProfiler {
+public:
+    static LuaProfiler &getInstance();
+
+    LuaProfiler(const LuaProfiler &) = delete;
+    LuaProfiler &operator=(const LuaProfiler &) = delete;
+
+    bool isEnabled() const {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    void setEnabled(bool enable) {
+        enabled.store(enable, std::memory_order_relaxed);
+    }
+
+    bool isActive() const {
+        return isEnabled() || slowCallThreshold.load(std::memory_order_relaxed) > 0;
+    }
+
+    // 0 disables the slow call log
+    void setSlowCallThreshold(std::chrono::microseconds threshold) {
+        slowCallThreshold.store(threshold.count(), std::memory_order_relaxed);
+    }
+
+    void record(const std::string &script, const std::string &entrypoint, std::chrono::microseconds duration, uint64_t allocated);
+
+    // profiles sorted by total time, at most count of them
+    std::vector<LuaProfile> getTop(size_t count) const;
+    std::vector<LuaProfile> getProfiles() const;
+    void reset();
+
+private:
+    LuaProfiler();
+
+    std::atomic<bool> enabled;
+    std::atomic<int64_t> slowCallThreshold;
+
+    mutable std::mutex profileMutex;
+    std::unordered_map<std::string, LuaProfile> profiles;
+};
+
+#endif
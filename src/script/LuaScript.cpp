@@ -43,11 +43,14 @@ extern "C" {
 
 #include "data/Data.hpp"
 
+#include "script/LuaGarbageCollector.hpp"
 #include "script/forwarder.hpp"
 #include "script/binding/binding.hpp"
 
 lua_State *LuaScript::_luaState = 0;
 bool LuaScript::initialized = false;
+uint32_t LuaScript::moduleGeneration = 0;
+uint32_t LuaScript::stateGeneration = 0;
 
 LuaScript::LuaScript() {
     initialize();
@@ -80,6 +83,7 @@ LuaScript::LuaScript(const std::string &code, const std::string &scriptname) {
 
     lua_setfield(_luaState, -2, _filename.c_str());
     lua_pop(_luaState, 1);
+    ++moduleGeneration;
 }
 
 void LuaScript::initialize() {
@@ -87,11 +91,17 @@ void LuaScript::initialize() {
         initialized = true;
         _luaState = luaL_newstate();
         luabind::open(_luaState);
+        LuaGarbageCollector::configure(_luaState);
 
         // use another error function to surpress errors from
         // non-existant entry points and to display a backtrace
         luabind::set_pcall_callback(LuaScript::add_backtrace);
 
+        auto &profiler = LuaProfiler::getInstance();
+        uint16_t slowCallThreshold = Config::instance().lua_slow_call_threshold;
+        profiler.setEnabled(Config::instance().lua_profiling != 0);
+        profiler.setSlowCallThreshold(std::chrono::milliseconds(slowCallThreshold));
+
         init_base_functions();
 
         char path[100];
@@ -108,6 +118,32 @@ void LuaScript::initialize() {
     }
 }
 
+namespace {
+
+uint64_t luaHeapSize(lua_State *L) {
+    return static_cast<uint64_t>(lua_gc(L, LUA_GCCOUNT, 0)) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+}
+
+}
+
+LuaScript::ProfiledCall::ProfiledCall(const std::string &script, const std::string &entrypoint)
+    : script(script), entrypoint(entrypoint), active(LuaProfiler::getInstance().isActive()) {
+    if (active) {
+        heapSize = luaHeapSize(_luaState);
+        start = std::chrono::steady_clock::now();
+    }
+}
+
+LuaScript::ProfiledCall::~ProfiledCall() {
+    if (active) {
+        const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        const auto newHeapSize = luaHeapSize(_luaState);
+        // a garbage collection step during the call hides allocations
+        const uint64_t allocated = newHeapSize > heapSize ? newHeapSize - heapSize : 0;
+        LuaProfiler::getInstance().record(script, entrypoint, duration, allocated);
+    }
+}
+
 void LuaScript::loadIntoLuaState() {
     luaL_getsubtable(_luaState, LUA_REGISTRYINDEX, "_LOADED");
 
@@ -121,6 +157,7 @@ void LuaScript::loadIntoLuaState() {
 
     lua_setfield(_luaState, -2, _filename.c_str());
     lua_pop(_luaState, 1);
+    ++moduleGeneration;
 }
 
 void LuaScript::handleLuaLoadError(int errorCode) {
@@ -168,6 +205,7 @@ void LuaScript::handleLuaCallError(int errorCode) {
 }
 
 LuaScript::~LuaScript() {
+    releaseEntrypoints();
 }
 
 void LuaScript::shutdownLua() {
@@ -177,6 +215,7 @@ void LuaScript::shutdownLua() {
         initialized = false;
         lua_close(_luaState);
         _luaState = 0;
+        ++stateGeneration;
     }
 }
 
@@ -270,22 +309,75 @@ void LuaScript::writeDeprecatedMsg(const std::string &deprecatedEntity) {
     }
 }
 
-luabind::object LuaScript::buildEntrypoint(const std::string &entrypoint) {
+auto LuaScript::resolveEntrypoint(const std::string &entrypoint) const -> EntrypointRef {
+    if (entrypointsModuleGeneration != moduleGeneration || entrypointsStateGeneration != stateGeneration) {
+        releaseEntrypoints();
+        entrypointsModuleGeneration = moduleGeneration;
+        entrypointsStateGeneration = stateGeneration;
+    }
+
+    const auto it = entrypoints.find(entrypoint);
+
+    if (it != entrypoints.end()) {
+        return it->second;
+    }
+
     luabind::object obj = luabind::registry(_luaState);
     obj = obj["_LOADED"][_filename];
 
+    // not cached, the module might still be loaded later
     if (luabind::type(obj) != LUA_TTABLE) {
+        return {LUA_NOREF, false};
+    }
+
+    luabind::object callee = obj[entrypoint];
+    EntrypointRef resolved;
+    resolved.isFunction = luabind::type(callee) == LUA_TFUNCTION;
+
+    if (resolved.isFunction) {
+        callee.push(_luaState);
+        resolved.ref = luaL_ref(_luaState, LUA_REGISTRYINDEX);
+    }
+
+    entrypoints.emplace(entrypoint, resolved);
+    return resolved;
+}
+
+void LuaScript::releaseEntrypoints() const {
+    // references of a closed Lua state need no cleanup
+    if (initialized && entrypointsStateGeneration == stateGeneration) {
+        for (const auto &entrypoint : entrypoints) {
+            luaL_unref(_luaState, LUA_REGISTRYINDEX, entrypoint.second.ref);
+        }
+    }
+
+    entrypoints.clear();
+}
+
+luabind::object LuaScript::buildEntrypoint(const std::string &entrypoint) {
+    const auto resolved = resolveEntrypoint(entrypoint);
+
+    if (resolved.ref == LUA_NOREF) {
         triggerScriptError(
             "Error while loading entrypoint '" + entrypoint + "' from module " +
             _filename + ". Check if the script returns its module as table.");
     }
 
-    luabind::object callee = obj[entrypoint];
+    lua_rawgeti(_luaState, LUA_REGISTRYINDEX, resolved.ref);
+    luabind::object callee(luabind::from_stack(_luaState, -1));
+    lua_pop(_luaState, 1);
     return callee;
 }
 
 void LuaScript::addQuestScript(const std::string &entrypoint, const std::shared_ptr<LuaScript> &script) {
-    questScripts.insert(std::pair<const std::string, std::shared_ptr<LuaScript> >(entrypoint, script));
+    for (auto &quest : questScripts) {
+        if (quest.entrypoint == entrypoint) {
+            quest.scripts.push_back(script);
+            return;
+        }
+    }
+
+    questScripts.push_back({entrypoint, {script}});
 }
 
 void LuaScript::setCurrentWorldScript() {
@@ -293,24 +385,17 @@ void LuaScript::setCurrentWorldScript() {
 }
 
 bool LuaScript::existsQuestEntrypoint(const std::string &entrypoint) const {
-    return questScripts.find(entrypoint) != questScripts.end();
-}
-
-bool LuaScript::existsEntrypoint(const std::string &entrypoint) const {
-    luabind::object obj = luabind::registry(_luaState);
-    obj = obj["_LOADED"][_filename];
-
-    if (luabind::type(obj) != LUA_TTABLE) {
-        return existsQuestEntrypoint(entrypoint);
+    for (const auto &quest : questScripts) {
+        if (quest.entrypoint == entrypoint) {
+            return true;
+        }
     }
 
-    obj = obj[entrypoint];
-
-    if (luabind::type(obj) != LUA_TFUNCTION) {
-        return existsQuestEntrypoint(entrypoint);
-    }
+    return false;
+}
 
-    return true;
+bool LuaScript::existsEntrypoint(const std::string &entrypoint) const {
+    return resolveEntrypoint(entrypoint).isFunction || existsQuestEntrypoint(entrypoint);
 }
 
 static int dofile(lua_State *L, const char *fname) {
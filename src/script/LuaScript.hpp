@@ -32,7 +32,9 @@ extern "C" {
 #include <luabind/luabind.hpp>
 #include <luabind/object.hpp>
 #include "character_ptr.hpp"
-#include <map>
+#include "script/LuaProfiler.hpp"
+#include <unordered_map>
+#include <vector>
 #include <cxxabi.h>
 
 class Character;
@@ -173,18 +175,45 @@ private:
 
     template<typename... Args>
     bool callQuestEntrypoint(const std::string &entrypoint, const Args &... args) {
-        auto entrypointRange = questScripts.equal_range(entrypoint);
+        if (questScripts.empty()) {
+            return false;
+        }
+
         bool foundQuest = false;
 
-        for (auto it = entrypointRange.first; it != entrypointRange.second; ++it) {
-            foundQuest = foundQuest || it->second->safeCall<bool>(entrypoint, args...);
+        for (const auto &quest : questScripts) {
+            if (quest.entrypoint == entrypoint) {
+                for (const auto &script : quest.scripts) {
+                    foundQuest = foundQuest || script->safeCall<bool>(entrypoint, args...);
+                }
+
+                break;
+            }
         }
 
         return foundQuest;
     }
 
+    /**
+    * measures one call into Lua if the profiler or the slow call log is active
+    */
+    class ProfiledCall {
+    public:
+        ProfiledCall(const std::string &script, const std::string &entrypoint);
+        ~ProfiledCall();
+
+    private:
+        const std::string &script;
+        const std::string &entrypoint;
+        bool active;
+        uint64_t heapSize = 0;
+        std::chrono::steady_clock::time_point start;
+    };
+
     template<typename... Args>
     void safeCall(const std::string &entrypoint, const Args &... args) {
+        ProfiledCall profiledCall(_filename, entrypoint);
+
         try {
             auto luaEntrypoint = buildEntrypoint(entrypoint);
             luaEntrypoint(args...);
@@ -194,6 +223,8 @@ private:
     };
     template<typename T, typename... Args>
     T safeCall(const std::string &entrypoint, const Args &... args) {
+        ProfiledCall profiledCall(_filename, entrypoint);
+
         try {
             auto luaEntrypoint = buildEntrypoint(entrypoint);
             auto result = luaEntrypoint(args...);
@@ -210,10 +241,38 @@ private:
     LuaScript(const LuaScript &);
     LuaScript &operator=(const LuaScript &);
 
+    /**
+    * registry reference to an entrypoint of this script's module,
+    * LUA_REFNIL if the module has no function of that name,
+    * LUA_NOREF if the module is not loaded
+    */
+    struct EntrypointRef {
+        int ref = LUA_REFNIL;
+        bool isFunction = false;
+    };
+
+    EntrypointRef resolveEntrypoint(const std::string &entrypoint) const;
+    void releaseEntrypoints() const;
+
+    // bumped whenever a module is (re)loaded, resolved entrypoints are then resolved again
+    static uint32_t moduleGeneration;
+    // bumped when the Lua state is closed, its references are gone with it
+    static uint32_t stateGeneration;
+
+    mutable std::unordered_map<std::string, EntrypointRef> entrypoints;
+    mutable uint32_t entrypointsModuleGeneration = 0;
+    mutable uint32_t entrypointsStateGeneration = 0;
+
     std::string _filename;
     char luafile[200];
-    typedef std::multimap<const std::string, std::shared_ptr<LuaScript> > QuestScripts;
-    QuestScripts questScripts;
+
+    struct QuestEntrypoint {
+        std::string entrypoint;
+        std::vector<std::shared_ptr<LuaScript>> scripts;
+    };
+
+    // scripts have only a handful of quest entrypoints, if any
+    std::vector<QuestEntrypoint> questScripts;
 };
 
 #endif
@@ -28,7 +28,7 @@ namespace binding {
         luabind::value_vector items;
 
         for (const auto &item: Data::Items) {
-            const auto &name = item.second.serverName;
+            const auto &name = Data::Items.names(item.first).serverName;
 
             if (name.length() > 0) {
                 items.push_back(luabind::value(name.c_str(), item.second.id));
@@ -19,10 +19,31 @@
  */
 
 #include "TableStructs.hpp"
+#include "data/Data.hpp"
 #include "script/binding/binding.hpp"
 
 namespace binding {
 
+    namespace {
+
+        const TYPE_OF_ENGLISH &english(const ItemStruct &item) {
+            return Data::Items.names(item.id).English;
+        }
+
+        const TYPE_OF_GERMAN &german(const ItemStruct &item) {
+            return Data::Items.names(item.id).German;
+        }
+
+        const TYPE_OF_ENGLISH &englishDescription(const ItemStruct &item) {
+            return Data::Items.names(item.id).EnglishDescription;
+        }
+
+        const TYPE_OF_GERMAN &germanDescription(const ItemStruct &item) {
+            return Data::Items.names(item.id).GermanDescription;
+        }
+
+    }
+
     luabind::scope item_struct() {
         return luabind::class_<ItemStruct>("ItemStruct")
                 .def_readonly("id", &ItemStruct::id)
@@ -34,10 +55,10 @@ namespace binding {
                 .def_readonly("Worth", &ItemStruct::Worth)
                 .def_readonly("MaxStack", &ItemStruct::MaxStack)
                 .def_readonly("BuyStack", &ItemStruct::BuyStack)
-                .def_readonly("English", &ItemStruct::English)
-                .def_readonly("German", &ItemStruct::German)
-                .def_readonly("EnglishDescription", &ItemStruct::EnglishDescription)
-                .def_readonly("GermanDescription", &ItemStruct::GermanDescription)
+                .property("English", &english)
+                .property("German", &german)
+                .property("EnglishDescription", &englishDescription)
+                .property("GermanDescription", &germanDescription)
                 .def_readonly("Rareness", &ItemStruct::Rareness)
                 .def_readonly("Level", &ItemStruct::Level);
     }
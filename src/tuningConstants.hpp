@@ -24,11 +24,64 @@
 
 #define CLIENT_TIMEOUT 50
 
+// seconds a new connection may take to send its login command
+#define LOGIN_TIMEOUT 100
+
 // how many players to process each turn (maximum)
 #define MAXPLAYERSPROCESSED 5
 
+// capacities of the queues handing over players between network, login, save and game threads
+#define LOGIN_QUEUE_SIZE 1024
+#define LOGOUT_QUEUE_SIZE 4096
+#define IMMEDIATE_COMMANDS_QUEUE_SIZE 4096
+
+// formatted log messages waiting for the log writer, more are dropped
+#define LOG_QUEUE_SIZE 16384
+// messages written per batch and ms between batches if nothing urgent is logged
+#define LOG_WRITE_BATCH 256
+#define LOG_WRITE_INTERVAL 50
+
 #define MIN_AP_UPDATE 100
 
+// largest area in fields a batched line of sight check caches the fields of
+#define MAX_SIGHT_BATCH_AREA 4096
+
+// monsters whose turns are prepared together in parallel, see World::checkMonsters
+#define MONSTER_PLAN_BATCH 128
+// upper bound for the automatically chosen number of monster ai workers
+#define MAX_MONSTER_AI_WORKERS 8
+// monsters without a player within this many fields skip their turns and
+// catch up on actionpoints and effects only every few monster cycles
+#define MONSTER_WAKE_RANGE 40
+#define MONSTER_SLEEP_INTERVAL 10
+
+// time budgets in ms per scheduler run, longer runs are reported as overruns
+#define TURN_BUDGET 50
+#define MONSTER_TURN_BUDGET 30
+#define MAP_AGING_BUDGET 10
+#define SCHEDULED_SCRIPTS_BUDGET 20
+#define INVENTORY_AGING_BUDGET 50
+#define LUA_GC_BUDGET 5
+
+// ms between Lua garbage collection steps and size of a single step in KB
+#define LUA_GC_STEP_INTERVAL 50
+#define LUA_GC_STEP_SIZE 16
+
+// fields with rotting items are aged every MAP_AGEING_INTERVAL seconds,
+// spread over this many buckets which are aged one after another
+#define MAP_AGEING_INTERVAL 180
+#define MAP_AGEING_BUCKETS 180
+
+// changed fields are sent to players up to this distance, as stripes of at most this many fields
+#define MAX_FIELD_VIEW_RANGE 36
+#define MAX_CHANGED_FIELDS_STRIPE 100
+
+// at most this many queued commands are written to a connection at once
+#define MAX_COMMANDS_PER_WRITE 64
+
+// how often scheduler overruns are reported, in minutes
+#define SCHEDULER_REPORT_INTERVAL 5
+
 #define P_MIN_AP 7
 #define P_MAX_AP 21
 
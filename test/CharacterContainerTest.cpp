@@ -68,10 +68,10 @@ TEST_F(CharacterContainerTest, find) {
 }
 
 TEST_F(CharacterContainerTest, update) {
-    container.update(&character, pos);
+    EXPECT_FALSE(container.update(&character, pos));
     EXPECT_EQ(0, container.size());
     container.insert(&character);
-    container.update(&character, pos);
+    EXPECT_TRUE(container.update(&character, pos));
     EXPECT_EQ(1, container.size());
 }
 
@@ -0,0 +1,195 @@
+// Logs in a number of synthetic characters at once against a running server
+// and reports how long each login took until the server sent the character id.
+//
+// The characters have to exist in the server's database, e.g. created by
+//
+//   INSERT INTO accounts.account (acc_login, acc_passwd, acc_lastip, acc_state)
+//     SELECT 'bench' || i, 'bench', '127.0.0.1', 3 FROM generate_series(1, 500) i;
+//   INSERT INTO server.chars (chr_accid, chr_playerid, chr_status, chr_race, chr_sex, chr_name)
+//     SELECT acc_id, 1000000 + acc_id, 0, 0, 0, acc_login FROM accounts.account WHERE acc_login LIKE 'bench%';
+//   INSERT INTO server.player (ply_playerid, ply_age)
+//     SELECT chr_playerid, 20 FROM server.chars WHERE chr_name LIKE 'bench%';
+//
+// usage: login_benchmark host port clientversion count [prefix] [password]
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#include <boost/asio.hpp>
+
+#include "netinterface/protocol/ClientCommands.hpp"
+#include "netinterface/protocol/ServerCommands.hpp"
+
+using boost::asio::ip::tcp;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+std::vector<unsigned char> loginCommand(unsigned char version, const std::string &name, const std::string &password) {
+    std::vector<unsigned char> data;
+    data.push_back(version);
+
+    for (const auto &str : {name, password}) {
+        data.push_back(str.size() >> 8);
+        data.push_back(str.size() & 255);
+        data.insert(data.end(), str.begin(), str.end());
+    }
+
+    int crc = 0;
+
+    for (auto c : data) {
+        crc += c;
+    }
+
+    crc %= 0xFFFF;
+
+    std::vector<unsigned char> command = {
+        C_LOGIN_TS, C_LOGIN_TS xor 255,
+        static_cast<unsigned char>(data.size() >> 8), static_cast<unsigned char>(data.size() & 255),
+        static_cast<unsigned char>(crc >> 8), static_cast<unsigned char>(crc & 255)
+    };
+    command.insert(command.end(), data.begin(), data.end());
+    return command;
+}
+
+struct LoginResult {
+    bool success = false;
+    int reason = -1;
+    std::chrono::microseconds duration{0};
+};
+
+LoginResult login(const tcp::endpoint &endpoint, const std::vector<unsigned char> &command, tcp::socket &socket) {
+    LoginResult result;
+    const auto start = Clock::now();
+
+    try {
+        socket.connect(endpoint);
+
+        timeval timeout = {60, 0};
+        setsockopt(socket.native_handle(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        boost::asio::write(socket, boost::asio::buffer(command));
+
+        unsigned char header[6];
+        std::vector<unsigned char> body;
+
+        while (true) {
+            boost::asio::read(socket, boost::asio::buffer(header, 6));
+            const uint16_t length = (header[2] << 8) | header[3];
+            body.resize(length);
+            boost::asio::read(socket, boost::asio::buffer(body));
+
+            if (header[0] == SC_ID_TC) {
+                result.success = true;
+                break;
+            }
+
+            if (header[0] == SC_LOGOUT_TC) {
+                result.reason = body.empty() ? -1 : body[0];
+                break;
+            }
+        }
+    } catch (std::exception &e) {
+        std::cerr << "login failed: " << e.what() << std::endl;
+    }
+
+    result.duration = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+    return result;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 5) {
+        std::cerr << "usage: " << argv[0] << " host port clientversion count [prefix] [password]" << std::endl;
+        return 1;
+    }
+
+    const std::string host = argv[1];
+    const std::string port = argv[2];
+    const auto version = static_cast<unsigned char>(std::stoi(argv[3]));
+    const int count = std::stoi(argv[4]);
+    const std::string prefix = argc > 5 ? argv[5] : "bench";
+    const std::string password = argc > 6 ? argv[6] : "bench";
+
+    boost::asio::io_service io_service;
+    tcp::resolver resolver(io_service);
+    const tcp::endpoint endpoint = *resolver.resolve(tcp::resolver::query(host, port));
+
+    std::vector<LoginResult> results(count);
+    std::vector<std::unique_ptr<tcp::socket>> sockets;
+    std::vector<std::thread> clients;
+
+    std::mutex startMutex;
+    std::condition_variable startSignal;
+    bool started = false;
+
+    for (int i = 0; i < count; ++i) {
+        sockets.push_back(std::make_unique<tcp::socket>(io_service));
+        clients.emplace_back([&, i] {
+            const auto command = loginCommand(version, prefix + std::to_string(i + 1), password);
+            {
+                std::unique_lock<std::mutex> lock(startMutex);
+                startSignal.wait(lock, [&] { return started; });
+            }
+            results[i] = login(endpoint, command, *sockets[i]);
+        });
+    }
+
+    const auto start = Clock::now();
+    {
+        std::lock_guard<std::mutex> lock(startMutex);
+        started = true;
+    }
+    startSignal.notify_all();
+
+    for (auto &client : clients) {
+        client.join();
+    }
+
+    const auto total = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start);
+
+    std::vector<std::chrono::microseconds> durations;
+    int failed = 0;
+
+    for (int i = 0; i < count; ++i) {
+        if (results[i].success) {
+            durations.push_back(results[i].duration);
+        } else {
+            ++failed;
+
+            if (results[i].reason >= 0) {
+                std::cerr << prefix << i + 1 << " was logged out with reason " << results[i].reason << std::endl;
+            }
+        }
+    }
+
+    std::sort(durations.begin(), durations.end());
+
+    std::cout << "logins: " << durations.size() << " ok, " << failed << " failed in " << total.count() << "ms" << std::endl;
+
+    if (!durations.empty()) {
+        auto percentile = [&durations](double p) {
+            return durations[std::min(durations.size() - 1, static_cast<size_t>(p * durations.size()))].count() / 1000.0;
+        };
+
+        std::cout << "latency ms: p50 " << percentile(0.5) << ", p95 " << percentile(0.95) << ", max " << percentile(1.0) << std::endl;
+    }
+
+    for (auto &socket : sockets) {
+        boost::system::error_code ignored;
+        socket->close(ignored);
+    }
+
+    return failed == 0 ? 0 : 1;
+}
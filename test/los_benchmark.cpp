@@ -0,0 +1,121 @@
+// Measures line of sight checks in a typical fight: one attacker looks at all
+// characters within nine fields, like World::findTargetsInSight does. The
+// characters stand on a 200x200 test map, every tenth field is occupied and
+// blocks the view. Item blockers need the item table from the database, so
+// only characters block here.
+//
+// usage: los_benchmark [rounds]
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "World.hpp"
+#include "Field.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using namespace std::chrono;
+
+const short mapSize = 200;
+const short range = 9;
+
+class BenchmarkWorld : public World {
+public:
+    BenchmarkWorld() {
+        World::_self = this;
+    }
+
+    bool createMap() {
+        return maps.createMap("benchmark", position(0, 0, 0), mapSize, mapSize, 2);
+    }
+};
+
+double millisecondsSince(Clock::time_point start) {
+    return duration_cast<microseconds>(Clock::now() - start).count() / 1000.0;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    const size_t rounds = argc > 1 ? std::stoul(argv[1]) : 10000;
+
+    BenchmarkWorld world;
+
+    if (!world.createMap()) {
+        std::cerr << "could not create the test map" << std::endl;
+        return 1;
+    }
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<short> coordinate(range, mapSize - range - 1);
+    std::uniform_int_distribution<int> occupied(0, 9);
+
+    for (short x = 0; x < mapSize; ++x) {
+        for (short y = 0; y < mapSize; ++y) {
+            if (occupied(generator) == 0) {
+                world.fieldAt(position(x, y, 0)).setPlayer();
+            }
+        }
+    }
+
+    std::vector<std::pair<position, std::vector<position>>> fights;
+    fights.reserve(rounds);
+
+    for (size_t i = 0; i < rounds; ++i) {
+        const position attacker(coordinate(generator), coordinate(generator), 0);
+        std::vector<position> targets;
+
+        for (short x = attacker.x - range; x <= attacker.x + range; ++x) {
+            for (short y = attacker.y - range; y <= attacker.y + range; ++y) {
+                const position target(x, y, 0);
+
+                if (!(target == attacker) && world.fieldAt(target).hasPlayer()) {
+                    targets.push_back(target);
+                }
+            }
+        }
+
+        fights.emplace_back(attacker, std::move(targets));
+    }
+
+    size_t lines = 0;
+    size_t visible = 0;
+    auto start = Clock::now();
+
+    for (const auto &fight : fights) {
+        for (const auto &target : fight.second) {
+            visible += world.LoS(fight.first, target).empty();
+            ++lines;
+        }
+    }
+
+    std::cout << "LoS: " << millisecondsSince(start) << "ms for " << lines << " lines (" << visible << " visible)" << std::endl;
+
+    visible = 0;
+    start = Clock::now();
+
+    for (const auto &fight : fights) {
+        for (const auto &target : fight.second) {
+            visible += world.isInSight(fight.first, target);
+        }
+    }
+
+    std::cout << "isInSight: " << millisecondsSince(start) << "ms (" << visible << " visible)" << std::endl;
+
+    visible = 0;
+    start = Clock::now();
+
+    for (const auto &fight : fights) {
+        for (bool targetVisible : world.isInSight(fight.first, fight.second)) {
+            visible += targetVisible;
+        }
+    }
+
+    std::cout << "batched isInSight: " << millisecondsSince(start) << "ms (" << visible << " visible)" << std::endl;
+
+    return 0;
+}
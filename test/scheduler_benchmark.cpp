@@ -0,0 +1,159 @@
+// Schedules 100k one-shot tasks with delays of up to ten minutes, cancels every
+// tenth of them and runs the scheduler until all tasks are done, once with
+// ClockBasedScheduler and once with a priority queue of copied tasks like the
+// scheduler used before. The scheduler runs on a simulated clock, so only the
+// bookkeeping is measured.
+//
+// usage: scheduler_benchmark [count]
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Scheduler.hpp"
+
+namespace {
+
+struct simulated_clock {
+    typedef std::chrono::nanoseconds duration;
+    typedef duration::rep rep;
+    typedef duration::period period;
+    typedef std::chrono::time_point<simulated_clock> time_point;
+    static const bool is_steady = true;
+
+    static time_point current;
+
+    static time_point now() {
+        return current;
+    }
+};
+
+simulated_clock::time_point simulated_clock::current;
+
+using Clock = std::chrono::steady_clock;
+using namespace std::chrono;
+
+const auto step = milliseconds(100);
+const auto maxDelay = minutes(10);
+
+class QueueTask {
+public:
+    QueueTask(std::function<void()> task, simulated_clock::time_point next, const std::string &name) : task(task), next(next), name(name) {}
+
+    bool operator<(const QueueTask &other) const {
+        return other.next < next;
+    }
+
+    std::function<void()> task;
+    simulated_clock::time_point next;
+    std::string name;
+};
+
+double millisecondsSince(Clock::time_point start) {
+    return duration_cast<microseconds>(Clock::now() - start).count() / 1000.0;
+}
+
+void benchmarkWheel(const std::vector<nanoseconds> &delays) {
+    simulated_clock::current = simulated_clock::time_point();
+    ClockBasedScheduler<simulated_clock> scheduler;
+    std::vector<TaskHandle> handles;
+    handles.reserve(delays.size());
+    size_t executed = 0;
+
+    auto start = Clock::now();
+
+    for (const auto &delay : delays) {
+        handles.push_back(scheduler.addOneshotTask([&executed] { ++executed; }, delay, "benchmark_task"));
+    }
+
+    std::cout << "timing wheel: insert " << millisecondsSince(start) << "ms";
+
+    start = Clock::now();
+
+    for (size_t i = 0; i < handles.size(); i += 10) {
+        scheduler.cancelTask(handles[i]);
+    }
+
+    std::cout << ", cancel " << millisecondsSince(start) << "ms";
+
+    start = Clock::now();
+
+    while (scheduler.size() > 0) {
+        simulated_clock::current += step;
+        scheduler.run_once(nanoseconds::zero());
+    }
+
+    std::cout << ", run " << millisecondsSince(start) << "ms (" << executed << " tasks)" << std::endl;
+}
+
+void benchmarkQueue(const std::vector<nanoseconds> &delays) {
+    simulated_clock::current = simulated_clock::time_point();
+    std::priority_queue<QueueTask> tasks;
+    std::vector<bool> cancelled(delays.size());
+    size_t executed = 0;
+
+    auto start = Clock::now();
+
+    for (const auto &delay : delays) {
+        tasks.emplace([&executed] { ++executed; }, simulated_clock::now() + delay, "benchmark_task");
+    }
+
+    std::cout << "priority queue: insert " << millisecondsSince(start) << "ms";
+
+    // a priority queue cannot remove arbitrary tasks, so cancelled tasks are flagged and skipped
+    start = Clock::now();
+
+    for (size_t i = 0; i < delays.size(); i += 10) {
+        cancelled[i] = true;
+    }
+
+    std::cout << ", cancel " << millisecondsSince(start) << "ms";
+
+    start = Clock::now();
+
+    // run_once waits on a condition variable, do the same here to compare only the task bookkeeping
+    std::mutex signalMutex;
+    std::condition_variable signal;
+
+    while (!tasks.empty()) {
+        simulated_clock::current += step;
+        {
+            std::unique_lock<std::mutex> lock(signalMutex);
+            signal.wait_for(lock, nanoseconds::zero());
+        }
+
+        while (!tasks.empty() && simulated_clock::now() >= tasks.top().next) {
+            auto task = tasks.top();
+            tasks.pop();
+            task.task();
+        }
+    }
+
+    std::cout << ", run " << millisecondsSince(start) << "ms (" << executed << " tasks, including cancelled)" << std::endl;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    const size_t count = argc > 1 ? std::stoul(argv[1]) : 100000;
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<nanoseconds::rep> distribution(0, duration_cast<nanoseconds>(maxDelay).count());
+    std::vector<nanoseconds> delays;
+    delays.reserve(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        delays.emplace_back(distribution(generator));
+    }
+
+    benchmarkWheel(delays);
+    benchmarkQueue(delays);
+
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <gmock/gmock.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "bounded_queue.hpp"
+
+class bounded_queue_tests : public ::testing::Test {
+public:
+    bounded_queue_tests() : queue{4} {
+    }
+
+    bounded_queue<int> queue;
+};
+
+TEST_F(bounded_queue_tests, fifo_order) {
+    EXPECT_TRUE(queue.try_push(1));
+    EXPECT_TRUE(queue.try_push(2));
+    EXPECT_TRUE(queue.try_push(3));
+
+    int value = 0;
+    EXPECT_TRUE(queue.try_pop(value));
+    EXPECT_EQ(1, value);
+    EXPECT_TRUE(queue.try_pop(value));
+    EXPECT_EQ(2, value);
+    EXPECT_TRUE(queue.try_pop(value));
+    EXPECT_EQ(3, value);
+    EXPECT_FALSE(queue.try_pop(value));
+}
+
+TEST_F(bounded_queue_tests, try_push_fails_when_full) {
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.try_push(i));
+    }
+
+    EXPECT_FALSE(queue.try_push(4));
+    EXPECT_EQ(4u, queue.size());
+
+    int value = 0;
+    EXPECT_TRUE(queue.try_pop(value));
+    EXPECT_TRUE(queue.try_push(4));
+}
+
+TEST_F(bounded_queue_tests, wraps_around) {
+    int value = 0;
+
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(queue.try_push(i));
+        EXPECT_TRUE(queue.try_pop(value));
+        EXPECT_EQ(i, value);
+    }
+
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(bounded_queue_tests, pop_times_out_on_empty_queue) {
+    int value = 0;
+    EXPECT_FALSE(queue.pop(value, std::chrono::milliseconds(10)));
+}
+
+TEST_F(bounded_queue_tests, drain_respects_max) {
+    for (int i = 0; i < 4; ++i) {
+        queue.push(i);
+    }
+
+    std::vector<int> drained;
+    EXPECT_EQ(3u, queue.drain(std::back_inserter(drained), 3));
+    EXPECT_EQ(std::vector<int>({0, 1, 2}), drained);
+    EXPECT_EQ(1u, queue.size());
+}
+
+TEST_F(bounded_queue_tests, producers_and_consumer) {
+    const int producers = 4;
+    const int itemsPerProducer = 1000;
+    std::vector<std::thread> threads;
+
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([this] {
+            for (int i = 0; i < itemsPerProducer; ++i) {
+                queue.push(1);
+            }
+        });
+    }
+
+    int sum = 0;
+    int value = 0;
+
+    while (sum < producers * itemsPerProducer && queue.pop(value, std::chrono::seconds(5))) {
+        sum += value;
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(producers * itemsPerProducer, sum);
+    EXPECT_TRUE(queue.empty());
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
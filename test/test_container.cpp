@@ -2,9 +2,12 @@
 
 #include "Container.hpp"
 #include "World.hpp"
+#include "data/Data.hpp"
 
 const Item::id_type itemid_1 = 0x23;
 const Item::id_type itemid_2 = 0x42;
+const Item::id_type rotting_item = 0x50;
+const Item::id_type bag = 0x60;
 
 using ::testing::Return;
 using ::testing::ReturnRef;
@@ -71,6 +74,176 @@ TEST_F(container_tests, eraseItemWithoutDataDoesntDeleteDataItem) {
 	EXPECT_EQ(8, container.eraseItem(itemid_1, 10));
 }
 
+class TestItemTable : public ItemTable {
+public:
+    TestItemTable(TYPE_OF_WEIGHT weight_1) {
+        add(itemid_1, weight_1, 100, itemid_1);
+        add(itemid_2, 3, 1, itemid_2);
+        add(rotting_item, 7, 1, itemid_2);
+        add(bag, 20, 1, bag);
+        activateBuffer();
+    }
+
+private:
+    void add(Item::id_type id, TYPE_OF_WEIGHT weight, TYPE_OF_MAX_STACK maxStack, Item::id_type afterRot) {
+        ItemStruct item;
+        item.id = id;
+        item.Weight = weight;
+        item.MaxStack = maxStack;
+        item.ObjectAfterRot = afterRot;
+        item.AgeingSpeed = 5;
+        emplace(id, item);
+    }
+};
+
+class TestContainerTable : public ContainerObjectTable {
+public:
+    TestContainerTable() {
+        emplace(bag, 10);
+        activateBuffer();
+    }
+};
+
+int bruteForceWeight(const Container &container) {
+    int weight = 0;
+
+    for (const auto &slot : container.getItems()) {
+        const auto &item = slot.second;
+
+        if (item.isContainer()) {
+            weight += Data::Items[item.getId()].Weight;
+            const auto it = container.getContainers().find(slot.first);
+
+            if (it != container.getContainers().end()) {
+                weight += bruteForceWeight(*it->second);
+            }
+        } else {
+            weight += Data::Items[item.getId()].Weight * item.getNumber();
+        }
+    }
+
+    return weight;
+}
+
+int bruteForceCount(const Container &container, Item::id_type itemid) {
+    int count = 0;
+
+    for (const auto &slot : container.getItems()) {
+        if (slot.second.getId() == itemid) {
+            count += slot.second.getNumber();
+        }
+    }
+
+    for (const auto &slot : container.getContainers()) {
+        count += bruteForceCount(*slot.second, itemid);
+    }
+
+    return count;
+}
+
+void expectConsistent(Container &container) {
+    EXPECT_EQ(bruteForceWeight(container), container.weight());
+
+    for (auto itemid : {itemid_1, itemid_2, rotting_item, bag}) {
+        EXPECT_EQ(bruteForceCount(container, itemid), container.countItem(itemid)) << "item " << itemid;
+    }
+}
+
+class container_cache_tests : public container_tests {
+public:
+    container_cache_tests() {
+        Data::Items = TestItemTable(10);
+        Data::ContainerItems = TestContainerTable();
+    }
+};
+
+TEST_F(container_cache_tests, weightAndCountFollowInsertMergeAndErase) {
+    EXPECT_TRUE(container.InsertItem(Item{itemid_1, 30, 0}));
+    EXPECT_TRUE(container.InsertItem(Item{itemid_1, 90, 0}));
+    EXPECT_TRUE(container.InsertItem(Item{itemid_2, 1, 0}));
+    expectConsistent(container);
+    EXPECT_EQ(120, container.countItem(itemid_1));
+    EXPECT_EQ(1203, container.weight());
+
+    EXPECT_EQ(0, container.eraseItem(itemid_1, 100));
+    expectConsistent(container);
+    EXPECT_EQ(20, container.countItem(itemid_1));
+
+    EXPECT_EQ(0, container.increaseAtPos(1, 5));
+    expectConsistent(container);
+
+    EXPECT_TRUE(container.swapAtPos(2, itemid_1));
+    expectConsistent(container);
+    EXPECT_EQ(0, container.countItem(itemid_2));
+
+    Item taken;
+    Container *takenContainer = nullptr;
+    EXPECT_TRUE(container.TakeItemNr(1, taken, takenContainer, 10));
+    EXPECT_EQ(10, taken.getNumber());
+    expectConsistent(container);
+}
+
+TEST_F(container_cache_tests, nestedChangesReachParent) {
+    auto innerBag = new Container(bag);
+    EXPECT_TRUE(container.InsertContainer(Item{bag, 1, 0}, innerBag));
+    EXPECT_TRUE(innerBag->InsertItem(Item{itemid_1, 5, 0}));
+    expectConsistent(container);
+    EXPECT_EQ(70, container.weight());
+    EXPECT_EQ(5, container.countItem(itemid_1));
+
+    EXPECT_EQ(0, container.eraseItem(itemid_1, 2));
+    EXPECT_EQ(3, innerBag->countItem(itemid_1));
+    expectConsistent(container);
+
+    Item taken;
+    Container *takenContainer = nullptr;
+    EXPECT_TRUE(container.TakeItemNr(0, taken, takenContainer, 1));
+    EXPECT_EQ(innerBag, takenContainer);
+    expectConsistent(container);
+    EXPECT_EQ(0, container.weight());
+    EXPECT_EQ(30, innerBag->weight());
+
+    EXPECT_TRUE(innerBag->InsertItem(Item{itemid_2, 1, 0}));
+    EXPECT_EQ(0, container.countItem(itemid_2));
+    delete innerBag;
+}
+
+TEST_F(container_cache_tests, copyKeepsAggregates) {
+    auto innerBag = new Container(bag);
+    EXPECT_TRUE(container.InsertContainer(Item{bag, 1, 0}, innerBag));
+    EXPECT_TRUE(innerBag->InsertItem(Item{itemid_1, 5, 0}));
+
+    Container copy{container};
+    expectConsistent(copy);
+    EXPECT_EQ(container.weight(), copy.weight());
+}
+
+TEST_F(container_cache_tests, ageingUpdatesCounts) {
+    EXPECT_TRUE(container.InsertItem(Item{rotting_item, 1, 1}));
+    EXPECT_TRUE(container.InsertItem(Item{itemid_2, 1, 1}));
+    container.doAge();
+    expectConsistent(container);
+    EXPECT_EQ(0, container.countItem(rotting_item));
+    EXPECT_EQ(1, container.countItem(itemid_2));
+}
+
+TEST_F(container_cache_tests, weightFollowsItemTableReload) {
+    EXPECT_TRUE(container.InsertItem(Item{itemid_1, 4, 0}));
+    EXPECT_EQ(40, container.weight());
+
+    Data::Items = TestItemTable(15);
+    EXPECT_EQ(60, container.weight());
+    expectConsistent(container);
+}
+
+TEST_F(container_cache_tests, containerCannotBeNestedInItself) {
+    auto outer = new Container(bag);
+    auto inner = new Container(bag);
+    EXPECT_TRUE(outer->InsertContainer(Item{bag, 1, 0}, inner));
+    EXPECT_FALSE(inner->InsertContainer(Item{bag, 1, 0}, outer));
+    delete outer;
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
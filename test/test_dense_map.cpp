@@ -0,0 +1,134 @@
+#include <gmock/gmock.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "dense_map.hpp"
+
+class dense_map_tests : public ::testing::Test {
+public:
+    dense_map<uint16_t, std::string> map;
+};
+
+TEST_F(dense_map_tests, empty_by_default) {
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(0u, map.count(0));
+    EXPECT_TRUE(map.begin() == map.end());
+    EXPECT_THROW(map.at(0), std::out_of_range);
+}
+
+TEST_F(dense_map_tests, emplace_does_not_overwrite) {
+    EXPECT_TRUE(map.emplace(7, "seven"));
+    EXPECT_FALSE(map.emplace(7, "other"));
+    EXPECT_EQ(1u, map.size());
+    EXPECT_EQ("seven", map.at(7));
+}
+
+TEST_F(dense_map_tests, lookup_beyond_largest_key) {
+    map.emplace(3, "three");
+    EXPECT_EQ(0u, map.count(4));
+    EXPECT_EQ(0u, map.count(65535));
+    EXPECT_THROW(map.at(65535), std::out_of_range);
+}
+
+TEST_F(dense_map_tests, iteration_skips_gaps_in_key_order) {
+    map.emplace(42, "c");
+    map.emplace(1, "a");
+    map.emplace(17, "b");
+
+    std::vector<uint16_t> keys;
+    std::string values;
+
+    for (const auto &entry : map) {
+        keys.push_back(entry.first);
+        values += entry.second;
+    }
+
+    EXPECT_THAT(keys, ::testing::ElementsAre(1, 17, 42));
+    EXPECT_EQ("abc", values);
+}
+
+TEST_F(dense_map_tests, erase) {
+    map.emplace(5, "five");
+    map.emplace(6, "six");
+
+    EXPECT_EQ(1u, map.erase(5));
+    EXPECT_EQ(0u, map.erase(5));
+    EXPECT_EQ(0u, map.count(5));
+    EXPECT_EQ(1u, map.size());
+    EXPECT_EQ(6, map.begin()->first);
+}
+
+TEST_F(dense_map_tests, swap_and_clear) {
+    dense_map<uint16_t, std::string> other;
+    other.emplace(9, "nine");
+
+    map.swap(other);
+    EXPECT_TRUE(other.empty());
+    EXPECT_EQ("nine", map.at(9));
+
+    map.clear();
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(0u, map.count(9));
+}
+
+TEST_F(dense_map_tests, find_and_insert) {
+    EXPECT_TRUE(map.find(3) == map.end());
+
+    auto inserted = map.insert({3, "three"});
+    EXPECT_TRUE(inserted.second);
+    EXPECT_EQ(3, inserted.first->first);
+
+    auto again = map.insert({3, "other"});
+    EXPECT_FALSE(again.second);
+    EXPECT_TRUE(again.first == map.find(3));
+    EXPECT_EQ("three", map.find(3)->second);
+
+    map.find(3)->second = "changed";
+    EXPECT_EQ("changed", map.at(3));
+}
+
+TEST_F(dense_map_tests, erase_while_iterating) {
+    for (uint16_t key = 0; key < 200; ++key) {
+        map.emplace(key, std::to_string(key));
+    }
+
+    auto it = map.begin();
+
+    while (it != map.end()) {
+        if (it->first % 3 == 0) {
+            it = map.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    EXPECT_EQ(133u, map.size());
+
+    for (const auto &entry : map) {
+        EXPECT_NE(0, entry.first % 3);
+    }
+}
+
+TEST_F(dense_map_tests, first_unused) {
+    EXPECT_EQ(0, map.first_unused());
+
+    for (uint16_t key = 0; key < 130; ++key) {
+        map.emplace(key, "");
+    }
+
+    EXPECT_EQ(130, map.first_unused());
+
+    map.erase(70);
+    EXPECT_EQ(70, map.first_unused());
+
+    map.erase(5);
+    EXPECT_EQ(5, map.first_unused());
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
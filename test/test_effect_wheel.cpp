@@ -0,0 +1,85 @@
+#include <gmock/gmock.h>
+
+#include <vector>
+
+#include "EffectWheel.hpp"
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+namespace {
+
+std::vector<TYPE_OF_CHARACTER_ID> advance(EffectWheel &wheel) {
+    std::vector<TYPE_OF_CHARACTER_ID> visited;
+    wheel.advance([&visited](TYPE_OF_CHARACTER_ID id) {
+        visited.push_back(id);
+    });
+    return visited;
+}
+
+}
+
+TEST(effect_wheel_tests, visits_characters_when_due) {
+    EffectWheel wheel;
+    EXPECT_EQ(3, wheel.schedule(1, 3));
+    EXPECT_EQ(2, wheel.schedule(2, 2));
+    EXPECT_EQ(3, wheel.schedule(3, 3));
+    EXPECT_EQ(3u, wheel.size());
+
+    EXPECT_THAT(advance(wheel), IsEmpty());
+    EXPECT_THAT(advance(wheel), ElementsAre(2));
+    EXPECT_THAT(advance(wheel), ElementsAre(1, 3));
+    EXPECT_EQ(3, wheel.now());
+    EXPECT_EQ(0u, wheel.size());
+}
+
+TEST(effect_wheel_tests, past_ticks_are_filed_for_the_next_tick) {
+    EffectWheel wheel;
+    advance(wheel);
+    advance(wheel);
+
+    EXPECT_EQ(3, wheel.schedule(1, 0));
+    EXPECT_EQ(3, wheel.schedule(2, 2));
+    EXPECT_THAT(advance(wheel), ElementsAre(1, 2));
+}
+
+TEST(effect_wheel_tests, keeps_entries_of_later_revolutions) {
+    EffectWheel wheel;
+    const EffectWheel::tick_t farAway = 4096 * 2 + 5;
+    wheel.schedule(1, 5);
+    wheel.schedule(2, farAway);
+
+    for (EffectWheel::tick_t tick = 1; tick < farAway; ++tick) {
+        const auto visited = advance(wheel);
+
+        if (tick == 5) {
+            EXPECT_THAT(visited, ElementsAre(1));
+        } else {
+            EXPECT_THAT(visited, IsEmpty());
+        }
+    }
+
+    EXPECT_THAT(advance(wheel), ElementsAre(2));
+}
+
+TEST(effect_wheel_tests, visitors_may_schedule_again) {
+    EffectWheel wheel;
+    wheel.schedule(1, 1);
+
+    int visits = 0;
+
+    for (int i = 0; i < 10; ++i) {
+        wheel.advance([&wheel, &visits](TYPE_OF_CHARACTER_ID id) {
+            ++visits;
+            wheel.schedule(id, wheel.now());
+        });
+    }
+
+    EXPECT_EQ(10, visits);
+    EXPECT_EQ(1u, wheel.size());
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
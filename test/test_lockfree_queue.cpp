@@ -0,0 +1,79 @@
+#include <gmock/gmock.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lockfree_queue.hpp"
+
+TEST(lockfree_queue_tests, capacity_is_rounded_up_to_power_of_two) {
+    lockfree_queue<int> queue{5};
+    EXPECT_EQ(8u, queue.capacity());
+}
+
+TEST(lockfree_queue_tests, fifo_order_and_full_queue) {
+    lockfree_queue<std::string> queue{4};
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.try_push(std::to_string(i)));
+    }
+
+    EXPECT_FALSE(queue.try_push("overflow"));
+    EXPECT_EQ(4u, queue.size());
+
+    std::string value;
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.try_pop(value));
+        EXPECT_EQ(std::to_string(i), value);
+    }
+
+    EXPECT_FALSE(queue.try_pop(value));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(lockfree_queue_tests, concurrent_producers_lose_nothing) {
+    const int producers = 4;
+    const int items = 10000;
+    lockfree_queue<int> queue{64};
+    std::vector<std::thread> threads;
+
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&queue, p] {
+            for (int i = 0; i < items; ++i) {
+                int item = p * items + i;
+
+                while (!queue.try_push(std::move(item))) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<int> lastOfProducer(producers, -1);
+    int received = 0;
+    int value = 0;
+
+    while (received < producers * items) {
+        if (queue.try_pop(value)) {
+            // every producer's items arrive in order
+            const int producer = value / items;
+            EXPECT_LT(lastOfProducer[producer], value);
+            lastOfProducer[producer] = value;
+            ++received;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_TRUE(queue.empty());
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,57 @@
+#include <gmock/gmock.h>
+
+#include "script/LuaProfiler.hpp"
+
+using std::chrono::microseconds;
+
+class lua_profiler_tests : public ::testing::Test {
+protected:
+    void SetUp() override {
+        profiler.reset();
+        profiler.setEnabled(true);
+    }
+
+    void TearDown() override {
+        profiler.setEnabled(false);
+    }
+
+    LuaProfiler &profiler = LuaProfiler::getInstance();
+};
+
+TEST_F(lua_profiler_tests, calls_are_recorded_per_entrypoint) {
+    profiler.record("item.foo", "UseItem", microseconds(100), 64);
+    profiler.record("item.foo", "UseItem", microseconds(300), 0);
+    profiler.record("item.foo", "LookAtItem", microseconds(10), 0);
+
+    const auto profiles = profiler.getTop(10);
+    ASSERT_EQ(2u, profiles.size());
+    EXPECT_EQ("item.foo", profiles[0].script);
+    EXPECT_EQ("UseItem", profiles[0].entrypoint);
+    EXPECT_EQ(2u, profiles[0].time.count);
+    EXPECT_EQ(400u, profiles[0].time.sum);
+    EXPECT_EQ(64u, profiles[0].allocated);
+    EXPECT_EQ("LookAtItem", profiles[1].entrypoint);
+}
+
+TEST_F(lua_profiler_tests, top_is_limited_and_sorted_by_total_time) {
+    profiler.record("a", "f", microseconds(1), 0);
+    profiler.record("b", "f", microseconds(3), 0);
+    profiler.record("c", "f", microseconds(2), 0);
+
+    const auto profiles = profiler.getTop(2);
+    ASSERT_EQ(2u, profiles.size());
+    EXPECT_EQ("b", profiles[0].script);
+    EXPECT_EQ("c", profiles[1].script);
+}
+
+TEST_F(lua_profiler_tests, nothing_is_recorded_while_disabled) {
+    profiler.setEnabled(false);
+    profiler.record("a", "f", microseconds(1), 0);
+
+    EXPECT_TRUE(profiler.getProfiles().empty());
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
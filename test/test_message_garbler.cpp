@@ -0,0 +1,85 @@
+#include <gmock/gmock.h>
+
+#include <string>
+
+#include "MessageGarbler.hpp"
+
+namespace {
+
+size_t garbledCharacters(const std::string &message) {
+    size_t count = 0;
+
+    for (auto c : message) {
+        if (c == '*') {
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+}
+
+TEST(message_garbler_tests, skilled_listeners_get_the_message) {
+    const std::string message = "Hello there!";
+    MessageGarbler garbler(message);
+
+    EXPECT_EQ(&message, &garbler.forSkill(70));
+    EXPECT_EQ(&message, &garbler.forSkill(100));
+}
+
+TEST(message_garbler_tests, unskilled_listeners_get_nothing) {
+    const std::string message = "Hello there!";
+    MessageGarbler garbler(message);
+
+    EXPECT_EQ(std::string(message.size(), '*'), garbler.forSkill(-1));
+    EXPECT_EQ(std::string(message.size(), '*'), garbler.forSkill(-50));
+}
+
+TEST(message_garbler_tests, same_skill_shares_result) {
+    const std::string message(200, 'a');
+    MessageGarbler garbler(message);
+
+    const auto &first = garbler.forSkill(30);
+    EXPECT_EQ(&first, &garbler.forSkill(30));
+    EXPECT_EQ(message.size(), first.size());
+}
+
+TEST(message_garbler_tests, better_skill_garbles_subset) {
+    const std::string message(500, 'a');
+    MessageGarbler garbler(message);
+
+    const auto &worse = garbler.forSkill(20);
+    const auto &better = garbler.forSkill(50);
+
+    for (size_t i = 0; i < message.size(); ++i) {
+        if (better[i] == '*') {
+            EXPECT_EQ('*', worse[i]) << "at " << i;
+        }
+    }
+}
+
+TEST(message_garbler_tests, garbles_expected_share) {
+    const std::string message(71000, 'a');
+
+    for (int skill : {0, 35, 60}) {
+        const auto garbled = garbledCharacters(MessageGarbler::garble(message, skill));
+        const double expected = message.size() * (70.0 - skill) / 71.0;
+        EXPECT_NEAR(expected, garbled, message.size() * 0.01) << "skill " << skill;
+    }
+}
+
+TEST(message_garbler_tests, stops_at_terminator) {
+    std::string message = "abc";
+    message += '\0';
+    message += "def";
+
+    const auto garbled = MessageGarbler::garble(message, -1);
+    EXPECT_EQ("***", garbled.substr(0, 3));
+    EXPECT_EQ(message.substr(3), garbled.substr(3));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,111 @@
+#include <gmock/gmock.h>
+
+#include <cstdint>
+#include <limits>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "Random.hpp"
+
+TEST(random_tests, seeding_is_reproducible) {
+    Random::seed(42);
+    std::vector<int> first;
+
+    for (int i = 0; i < 100; ++i) {
+        first.push_back(Random::uniform(0, 1000));
+    }
+
+    const double firstReal = Random::uniform();
+    const double firstNormal = Random::normal(0, 1);
+
+    Random::seed(42);
+
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(first[i], Random::uniform(0, 1000));
+    }
+
+    EXPECT_EQ(firstReal, Random::uniform());
+    EXPECT_EQ(firstNormal, Random::normal(0, 1));
+}
+
+TEST(random_tests, uniform_int_stays_in_range) {
+    Random::seed(1);
+    std::set<int> seen;
+
+    for (int i = 0; i < 10000; ++i) {
+        const int value = Random::uniform(-3, 3);
+        EXPECT_GE(value, -3);
+        EXPECT_LE(value, 3);
+        seen.insert(value);
+    }
+
+    EXPECT_EQ(7u, seen.size());
+    EXPECT_EQ(5, Random::uniform(5, 5));
+    EXPECT_EQ(-1, Random::uniform(-1, -1));
+}
+
+TEST(random_tests, uniform_int_full_range) {
+    Random::seed(2);
+    bool negative = false;
+    bool positive = false;
+
+    for (int i = 0; i < 1000; ++i) {
+        const int value = Random::uniform(std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+        negative |= value < 0;
+        positive |= value > 0;
+    }
+
+    EXPECT_TRUE(negative);
+    EXPECT_TRUE(positive);
+}
+
+TEST(random_tests, uniform_real_stays_in_range) {
+    Random::seed(3);
+    double sum = 0;
+
+    for (int i = 0; i < 10000; ++i) {
+        const double value = Random::uniform();
+        EXPECT_GE(value, 0.0);
+        EXPECT_LT(value, 1.0);
+        sum += value;
+    }
+
+    EXPECT_NEAR(0.5, sum / 10000, 0.02);
+}
+
+TEST(random_tests, bulk_uniform_matches_single_draws) {
+    Random::seed(4);
+    std::vector<int> single;
+
+    for (int i = 0; i < 50; ++i) {
+        single.push_back(Random::uniform(1, 6));
+    }
+
+    Random::seed(4);
+    std::vector<int> bulk(50);
+    Random::uniform(1, 6, bulk.data(), bulk.size());
+    EXPECT_EQ(single, bulk);
+}
+
+TEST(random_tests, threads_draw_different_streams) {
+    Random::seed(5);
+    uint64_t words[2][4] = {};
+
+    std::thread first([&words] {
+        Random::fill(words[0], 4);
+    });
+    first.join();
+
+    std::thread second([&words] {
+        Random::fill(words[1], 4);
+    });
+    second.join();
+
+    EXPECT_NE(std::vector<uint64_t>(words[0], words[0] + 4), std::vector<uint64_t>(words[1], words[1] + 4));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,248 @@
+#include <gmock/gmock.h>
+
+#include <chrono>
+#include <vector>
+
+#include "Scheduler.hpp"
+
+struct manual_clock {
+    typedef std::chrono::nanoseconds duration;
+    typedef duration::rep rep;
+    typedef duration::period period;
+    typedef std::chrono::time_point<manual_clock> time_point;
+    static const bool is_steady = true;
+
+    static time_point current;
+
+    static time_point now() {
+        return current;
+    }
+
+    static void advance(duration d) {
+        current += d;
+    }
+};
+
+manual_clock::time_point manual_clock::current;
+
+using namespace std::chrono;
+
+class scheduler_tests : public ::testing::Test {
+public:
+    scheduler_tests() {
+        manual_clock::current = manual_clock::time_point();
+        scheduler = std::make_unique<ClockBasedScheduler<manual_clock>>();
+    }
+
+    void runFor(manual_clock::duration d) {
+        manual_clock::advance(d);
+        scheduler->run_once(nanoseconds::zero());
+    }
+
+    std::unique_ptr<ClockBasedScheduler<manual_clock>> scheduler;
+    std::vector<int> executed;
+};
+
+TEST_F(scheduler_tests, oneshot_runs_once_when_due) {
+    scheduler->addOneshotTask([this] { executed.push_back(1); }, milliseconds(50), "oneshot");
+
+    runFor(milliseconds(49));
+    EXPECT_TRUE(executed.empty());
+
+    runFor(milliseconds(1));
+    EXPECT_EQ(std::vector<int>({1}), executed);
+
+    runFor(seconds(10));
+    EXPECT_EQ(1u, executed.size());
+    EXPECT_EQ(0u, scheduler->size());
+}
+
+TEST_F(scheduler_tests, never_runs_early) {
+    scheduler->addOneshotTask([this] { executed.push_back(1); }, microseconds(1500), "oneshot");
+
+    runFor(milliseconds(1));
+    EXPECT_TRUE(executed.empty());
+
+    runFor(microseconds(499));
+    EXPECT_TRUE(executed.empty());
+
+    runFor(milliseconds(1));
+    EXPECT_EQ(1u, executed.size());
+}
+
+TEST_F(scheduler_tests, tasks_run_in_time_order) {
+    scheduler->addOneshotTask([this] { executed.push_back(3); }, seconds(70), "third");
+    scheduler->addOneshotTask([this] { executed.push_back(1); }, milliseconds(10), "first");
+    scheduler->addOneshotTask([this] { executed.push_back(2); }, milliseconds(300), "second");
+
+    runFor(minutes(2));
+    EXPECT_EQ(std::vector<int>({1, 2, 3}), executed);
+}
+
+TEST_F(scheduler_tests, recurring_task_catches_up) {
+    scheduler->addRecurringTask([this] { executed.push_back(1); }, milliseconds(100), "recurring");
+
+    runFor(milliseconds(350));
+    EXPECT_EQ(3u, executed.size());
+
+    runFor(milliseconds(50));
+    EXPECT_EQ(4u, executed.size());
+    EXPECT_EQ(1u, scheduler->size());
+}
+
+TEST_F(scheduler_tests, cancelled_task_does_not_run) {
+    auto handle = scheduler->addOneshotTask([this] { executed.push_back(1); }, seconds(5), "cancelled");
+    scheduler->addOneshotTask([this] { executed.push_back(2); }, seconds(5), "kept");
+
+    EXPECT_TRUE(scheduler->cancelTask(handle));
+    EXPECT_FALSE(scheduler->cancelTask(handle));
+
+    runFor(seconds(6));
+    EXPECT_EQ(std::vector<int>({2}), executed);
+}
+
+TEST_F(scheduler_tests, recurring_task_can_cancel_itself) {
+    TaskHandle handle;
+    handle = scheduler->addRecurringTask([this, &handle] {
+        executed.push_back(1);
+        scheduler->cancelTask(handle);
+    }, seconds(1), "self_cancel");
+
+    runFor(seconds(5));
+    EXPECT_EQ(1u, executed.size());
+    EXPECT_EQ(0u, scheduler->size());
+}
+
+TEST_F(scheduler_tests, stale_handle_does_not_cancel_new_task) {
+    auto handle = scheduler->addOneshotTask([this] { executed.push_back(1); }, milliseconds(1), "first");
+    runFor(milliseconds(1));
+
+    scheduler->addOneshotTask([this] { executed.push_back(2); }, milliseconds(1), "second");
+    EXPECT_FALSE(scheduler->cancelTask(handle));
+
+    runFor(milliseconds(1));
+    EXPECT_EQ(std::vector<int>({1, 2}), executed);
+}
+
+TEST_F(scheduler_tests, far_future_tasks_survive_overflow) {
+    scheduler->addOneshotTask([this] { executed.push_back(1); }, hours(8), "far");
+
+    for (int i = 0; i < 8 * 60; ++i) {
+        runFor(minutes(1) - milliseconds(1));
+        runFor(milliseconds(1));
+    }
+
+    EXPECT_EQ(1u, executed.size());
+}
+
+TEST_F(scheduler_tests, task_added_while_running_is_scheduled) {
+    scheduler->addOneshotTask([this] {
+        executed.push_back(1);
+        scheduler->addOneshotTask([this] { executed.push_back(2); }, milliseconds(100), "rescheduled");
+    }, milliseconds(100), "initial");
+
+    runFor(milliseconds(100));
+    EXPECT_EQ(std::vector<int>({1}), executed);
+
+    runFor(milliseconds(100));
+    EXPECT_EQ(std::vector<int>({1, 2}), executed);
+}
+
+TEST_F(scheduler_tests, random_tasks_run_on_time) {
+    const int count = 2000;
+    std::vector<manual_clock::time_point> due(count);
+    std::vector<manual_clock::time_point> ran(count);
+    unsigned int seed = 42;
+
+    auto random = [&seed] {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 8) & 0xffffff;
+    };
+
+    for (int i = 0; i < count; ++i) {
+        const auto delay = microseconds(random() % 3000000) * ((i % 10) == 0 ? 100 : 1);
+        due[i] = manual_clock::now() + delay;
+        scheduler->addOneshotTask([&ran, i] { ran[i] = manual_clock::now(); }, delay, "random");
+    }
+
+    while (scheduler->size() > 0) {
+        runFor(microseconds(random() % 20000));
+    }
+
+    for (int i = 0; i < count; ++i) {
+        EXPECT_GE(ran[i], due[i]);
+        EXPECT_LT(ran[i], due[i] + milliseconds(21));
+    }
+}
+
+TEST_F(scheduler_tests, due_tasks_run_by_priority) {
+    scheduler->setTaskBudget("low", milliseconds(10), TaskPriority::low);
+    scheduler->setTaskBudget("high", milliseconds(10), TaskPriority::high);
+
+    scheduler->addOneshotTask([this] { executed.push_back(3); }, milliseconds(10), "low");
+    scheduler->addOneshotTask([this] { executed.push_back(2); }, milliseconds(10), "normal");
+    scheduler->addOneshotTask([this] { executed.push_back(1); }, milliseconds(10), "high");
+
+    runFor(milliseconds(10));
+    EXPECT_EQ(std::vector<int>({1, 2, 3}), executed);
+}
+
+TEST_F(scheduler_tests, sliced_task_resumes_until_finished) {
+    int work = 0;
+    std::vector<manual_clock::time_point> deadlines;
+
+    scheduler->setTaskBudget("sliced", milliseconds(5));
+    scheduler->addSlicedTask([&](manual_clock::time_point deadline) {
+        deadlines.push_back(deadline);
+        manual_clock::advance(milliseconds(5));
+        return ++work % 3 == 0;
+    }, seconds(1), milliseconds(100), "sliced");
+
+    runFor(seconds(1));
+    EXPECT_EQ(1, work);
+    EXPECT_EQ(manual_clock::time_point(seconds(1) + milliseconds(5)), deadlines.back());
+
+    runFor(milliseconds(100));
+    runFor(milliseconds(100));
+    EXPECT_EQ(3, work);
+
+    // the next cycle starts one interval after the last one started
+    runFor(milliseconds(500));
+    EXPECT_EQ(3, work);
+    runFor(milliseconds(300));
+    EXPECT_EQ(4, work);
+}
+
+TEST_F(scheduler_tests, overruns_are_counted_per_task) {
+    scheduler->setTaskBudget("slow", milliseconds(10));
+    scheduler->addRecurringTask([] { manual_clock::advance(milliseconds(15)); }, seconds(1), "slow");
+    scheduler->addRecurringTask([] { manual_clock::advance(milliseconds(5)); }, seconds(1), "fast");
+
+    for (int i = 0; i < 3; ++i) {
+        runFor(seconds(1));
+    }
+
+    bool foundSlow = false;
+
+    for (const auto &statistics : scheduler->getTaskStatistics(true)) {
+        if (statistics.name == "slow") {
+            foundSlow = true;
+            EXPECT_EQ(3u, statistics.runs);
+            EXPECT_EQ(3u, statistics.overruns);
+            EXPECT_EQ(milliseconds(15), statistics.longest);
+        } else {
+            EXPECT_EQ(0u, statistics.overruns);
+        }
+    }
+
+    EXPECT_TRUE(foundSlow);
+
+    for (const auto &statistics : scheduler->getTaskStatistics()) {
+        EXPECT_EQ(0u, statistics.runs);
+    }
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
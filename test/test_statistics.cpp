@@ -0,0 +1,150 @@
+#include <gmock/gmock.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "MetricsServer.hpp"
+#include "Statistics.hpp"
+
+using namespace Statistic;
+
+namespace {
+
+Histogram find(const std::string &name) {
+    for (const auto &histogram : Statistics::getInstance().getHistograms()) {
+        if (histogram.name == name) {
+            return histogram;
+        }
+    }
+
+    return Histogram();
+}
+
+}
+
+TEST(statistics_tests, buckets_cover_all_values) {
+    size_t previous = 0;
+
+    for (uint64_t value = 0; value < 100000; ++value) {
+        const auto bucket = Histogram::bucketOf(value);
+        EXPECT_LE(previous, bucket);
+        EXPECT_LE(Histogram::lowerBound(bucket), value);
+        EXPECT_GT(Histogram::upperBound(bucket), value);
+        previous = bucket;
+    }
+
+    EXPECT_EQ(Histogram::BUCKETS - 1, static_cast<int>(Histogram::bucketOf(UINT64_MAX)));
+}
+
+TEST(statistics_tests, registering_twice_returns_same_metric) {
+    auto &statistics = Statistics::getInstance();
+    const auto first = statistics.registerMetric("test_same");
+    const auto second = statistics.registerMetric("test_same");
+
+    statistics.record(first, 10);
+    statistics.record(second, 10);
+
+    const auto histogram = find("test_same");
+    ASSERT_EQ("test_same", histogram.name);
+    EXPECT_EQ(2u, histogram.count);
+    EXPECT_EQ(20u, histogram.sum);
+}
+
+TEST(statistics_tests, values_from_all_threads_are_merged) {
+    auto &statistics = Statistics::getInstance();
+    const auto metric = statistics.registerMetric("test_threads");
+    const int threadCount = 4;
+    const int values = 10000;
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < threadCount; ++i) {
+        threads.emplace_back([&statistics, metric] {
+            for (int value = 1; value <= values; ++value) {
+                statistics.record(metric, value);
+            }
+        });
+    }
+
+    // merging while the threads are still recording must not lose values
+    statistics.getHistograms();
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    const auto histogram = find("test_threads");
+    ASSERT_EQ("test_threads", histogram.name);
+    EXPECT_EQ(static_cast<uint64_t>(threadCount * values), histogram.count);
+    EXPECT_EQ(static_cast<uint64_t>(threadCount) * values * (values + 1) / 2, histogram.sum);
+
+    const auto median = histogram.percentile(0.5);
+    EXPECT_GE(median, 5000u);
+    EXPECT_LE(median, 5000u * 9 / 8 + 1);
+    EXPECT_GE(histogram.percentile(1.0), 10000u);
+}
+
+TEST(statistics_tests, durations_are_recorded_in_microseconds) {
+    auto &statistics = Statistics::getInstance();
+    const auto metric = statistics.registerMetric("test_duration");
+
+    statistics.record(metric, std::chrono::milliseconds(3));
+
+    const auto histogram = find("test_duration");
+    ASSERT_EQ("test_duration", histogram.name);
+    EXPECT_EQ(3000u, histogram.sum);
+}
+
+TEST(statistics_tests, counters_are_accumulated) {
+    auto &statistics = Statistics::getInstance();
+    const auto counter = statistics.registerCounter("test_counter");
+
+    statistics.increment(counter);
+    statistics.increment(counter, 4);
+
+    for (const auto &entry : statistics.getCounters()) {
+        if (entry.first == "test_counter") {
+            EXPECT_EQ(5u, entry.second);
+            return;
+        }
+    }
+
+    FAIL() << "counter not found";
+}
+
+TEST(statistics_tests, gauges_are_sampled_on_request) {
+    auto &statistics = Statistics::getInstance();
+    auto value = std::make_shared<double>(1);
+    statistics.registerGauge("test_gauge", [value] { return *value; });
+    *value = 42;
+
+    for (const auto &entry : statistics.getGauges()) {
+        if (entry.first == "test_gauge") {
+            EXPECT_EQ(42, entry.second);
+            return;
+        }
+    }
+
+    FAIL() << "gauge not found";
+}
+
+TEST(statistics_tests, prometheus_export_contains_all_series) {
+    auto &statistics = Statistics::getInstance();
+    const auto metric = statistics.registerMetric("test \"export\"");
+    statistics.record(metric, 50);
+    statistics.record(metric, 2000);
+    statistics.increment(statistics.registerCounter("test export"), 3);
+
+    const auto text = MetricsServer::render();
+
+    EXPECT_NE(std::string::npos, text.find("illarion_duration_seconds_bucket{name=\"test \\\"export\\\"\",le=\"0.0001\"} 1\n"));
+    EXPECT_NE(std::string::npos, text.find("illarion_duration_seconds_bucket{name=\"test \\\"export\\\"\",le=\"+Inf\"} 2\n"));
+    EXPECT_NE(std::string::npos, text.find("illarion_duration_seconds_count{name=\"test \\\"export\\\"\"} 2\n"));
+    EXPECT_NE(std::string::npos, text.find("illarion_test_export_total 3\n"));
+    EXPECT_NE(std::string::npos, text.find("illarion_players_online 0\n"));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
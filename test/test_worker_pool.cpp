@@ -0,0 +1,62 @@
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "WorkerPool.hpp"
+
+TEST(worker_pool_tests, every_index_is_called_once) {
+    WorkerPool pool{3};
+    std::vector<std::atomic<int>> calls(1000);
+
+    for (auto &call : calls) {
+        call = 0;
+    }
+
+    pool.parallelFor(calls.size(), [&calls](size_t i) {
+        ++calls[i];
+    });
+
+    for (const auto &call : calls) {
+        EXPECT_EQ(1, call);
+    }
+}
+
+TEST(worker_pool_tests, pool_can_be_reused) {
+    WorkerPool pool{2};
+    std::atomic<size_t> sum{0};
+
+    for (size_t round = 1; round <= 50; ++round) {
+        pool.parallelFor(round, [&sum](size_t i) {
+            sum += i + 1;
+        });
+    }
+
+    size_t expected = 0;
+
+    for (size_t round = 1; round <= 50; ++round) {
+        expected += round * (round + 1) / 2;
+    }
+
+    EXPECT_EQ(expected, sum);
+}
+
+TEST(worker_pool_tests, empty_pool_runs_on_caller) {
+    WorkerPool pool{0};
+    EXPECT_EQ(0u, pool.size());
+
+    const auto caller = std::this_thread::get_id();
+    bool onCaller = true;
+
+    pool.parallelFor(10, [&onCaller, caller](size_t) {
+        onCaller = onCaller && std::this_thread::get_id() == caller;
+    });
+
+    EXPECT_TRUE(onCaller);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}